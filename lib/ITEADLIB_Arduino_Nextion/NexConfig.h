@@ -36,6 +36,73 @@
  */
 #define nexSerial Serial
 
+/**
+ * Define NEX_SERIAL_SWAP to move nexSerial to the alternate pins of ESP8266 
+ * UART0 (TX GPIO15, RX GPIO13) whenever it is opened, leaving GPIO1/GPIO3 
+ * and the USB bridge free. Usually set from the build flags. 
+ */
+// #define NEX_SERIAL_SWAP
+
+/**
+ * Baud rate Nextion uses after power on, and nexInit talks at. 
+ */
+#define NEX_DEFAULT_BAUD        (9600)
+
+/**
+ * Milliseconds to let Nextion settle after nexSetBaud changes the rate. 
+ */
+#define NEX_BAUD_SETTLE         (50)
+
+/**
+ * Longest frame (header and payload, without the 0xFF 0xFF 0xFF terminator)
+ * the receive parser keeps. Longer frames are dropped. 
+ */
+#define NEX_PARSER_FRAME_MAX    (64)
+
+/**
+ * Bytes of ring buffer holding frames received but not yet dispatched. 
+ */
+#define NEX_PARSER_RING_SIZE    (128)
+
+/**
+ * Commands sent with nexSendCommand/nexGetString/nexGetNumber that may be 
+ * waiting for their reply at the same time. Further commands are refused 
+ * until a reply frees an entry. 
+ */
+#define NEX_CMD_QUEUE_SIZE      (24)
+
+/**
+ * Milliseconds a queued command may wait for its reply before it is 
+ * reported as failed with NEX_RET_CMD_TIMEOUT. 
+ */
+#define NEX_CMD_TIMEOUT         (500)
+
+/**
+ * Page ids covered by the touch dispatch table (0 to NEX_TOUCH_MAX_PAGES - 1). 
+ */
+#define NEX_TOUCH_MAX_PAGES     (16)
+
+/**
+ * Slots of the touch dispatch table: per page, one for every component id 
+ * between the lowest and the highest registered on that page. 
+ */
+#define NEX_TOUCH_TABLE_SIZE    (256)
+
+/**
+ * Bytes of a TFT upload the panel takes before acknowledging them with 0x05. 
+ */
+#define NEX_UPLOAD_CHUNK        (4096)
+
+/**
+ * Bytes of a TFT upload copied from the source at a time. 
+ */
+#define NEX_UPLOAD_COPY_SIZE    (256)
+
+/**
+ * Milliseconds to wait for the panel to acknowledge an upload chunk. 
+ */
+#define NEX_UPLOAD_ACK_TIMEOUT  (1000)
+
 
 #ifdef DEBUG_SERIAL_ENABLE
 #define dbSerialPrint(a)    dbSerial.print(a)
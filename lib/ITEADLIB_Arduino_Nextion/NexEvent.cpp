@@ -0,0 +1,147 @@
+/**
+ * @file NexEvent.cpp
+ *
+ * Decoding of frames returned by Nextion into typed events. 
+ *
+ * @copyright 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ */
+#include <string.h>
+#include "NexEvent.h"
+
+bool nexIsErrorCode(uint8_t code)
+{
+    switch (code)
+    {
+        case NEX_RET_INVALID_CMD:
+        case NEX_RET_INVALID_COMPONENT_ID:
+        case NEX_RET_INVALID_PAGE_ID:
+        case NEX_RET_INVALID_PICTURE_ID:
+        case NEX_RET_INVALID_FONT_ID:
+        case NEX_RET_INVALID_FILE_OPERATION:
+        case NEX_RET_INVALID_CRC:
+        case NEX_RET_INVALID_BAUD:
+        case NEX_RET_INVALID_WAVEFORM:
+        case NEX_RET_INVALID_VARIABLE:
+        case NEX_RET_INVALID_OPERATION:
+        case NEX_RET_ASSIGNMENT_FAILED:
+        case NEX_RET_EEPROM_FAILED:
+        case NEX_RET_INVALID_PARAM_COUNT:
+        case NEX_RET_IO_FAILED:
+        case NEX_RET_INVALID_ESCAPE:
+        case NEX_RET_NAME_TOO_LONG:
+        case NEX_RET_BUFFER_OVERFLOW:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool nexDecodeEvent(const uint8_t *frame, uint16_t len, NexEvent *event)
+{
+    if (!event)
+    {
+        return false;
+    }
+    
+    memset(event, 0, sizeof(*event));
+    if (!frame || 0 == len)
+    {
+        return false;
+    }
+    event->code = frame[0];
+
+    switch (frame[0])
+    {
+        case NEX_RET_CMD_FINISHED:
+            event->type = (1 == len) ? NEX_EVT_CMD_FINISHED : NEX_EVT_UNKNOWN;
+            break;
+
+        case NEX_RET_EVENT_TOUCH_HEAD:
+            if (4 == len)
+            {
+                event->type = NEX_EVT_TOUCH;
+                event->page_id = frame[1];
+                event->component_id = frame[2];
+                event->touch = frame[3];
+            }
+            break;
+
+        case NEX_RET_CURRENT_PAGE_ID_HEAD:
+            if (2 == len)
+            {
+                event->type = NEX_EVT_PAGE;
+                event->page_id = frame[1];
+            }
+            break;
+
+        case NEX_RET_EVENT_POSITION_HEAD:
+        case NEX_RET_EVENT_SLEEP_POSITION_HEAD:
+            if (6 == len)
+            {
+                event->type = (NEX_RET_EVENT_POSITION_HEAD == frame[0]) ? NEX_EVT_POSITION : NEX_EVT_SLEEP_POSITION;
+                event->x = ((uint16_t)frame[1] << 8) | frame[2];
+                event->y = ((uint16_t)frame[3] << 8) | frame[4];
+                event->touch = frame[5];
+            }
+            break;
+
+        case NEX_RET_STRING_HEAD:
+            event->type = NEX_EVT_STRING;
+            event->text = frame + 1;
+            event->text_len = len - 1;
+            break;
+
+        case NEX_RET_NUMBER_HEAD:
+            if (5 == len)
+            {
+                event->type = NEX_EVT_NUMBER;
+                event->number = ((uint32_t)frame[4] << 24) | ((uint32_t)frame[3] << 16) | ((uint32_t)frame[2] << 8) | frame[1];
+            }
+            break;
+
+        case NEX_RET_EVENT_SLEEP:
+            event->type = (1 == len) ? NEX_EVT_SLEEP : NEX_EVT_UNKNOWN;
+            break;
+
+        case NEX_RET_EVENT_WAKE:
+            event->type = (1 == len) ? NEX_EVT_WAKE : NEX_EVT_UNKNOWN;
+            break;
+
+        case NEX_RET_EVENT_LAUNCHED:
+            event->type = (1 == len) ? NEX_EVT_READY : NEX_EVT_UNKNOWN;
+            break;
+
+        case NEX_RET_EVENT_UPGRADED:
+            event->type = (1 == len) ? NEX_EVT_UPGRADE : NEX_EVT_UNKNOWN;
+            break;
+
+        case NEX_RET_TRANSPARENT_READY:
+            event->type = (1 == len) ? NEX_EVT_TRANSPARENT_READY : NEX_EVT_UNKNOWN;
+            break;
+
+        case NEX_RET_TRANSPARENT_FINISHED:
+            event->type = (1 == len) ? NEX_EVT_TRANSPARENT_DONE : NEX_EVT_UNKNOWN;
+            break;
+
+        case NEX_RET_INVALID_CMD:
+            /* 0x00 0x00 0x00 at power on, a lone 0x00 for an invalid instruction */
+            if (3 == len && 0x00 == frame[1] && 0x00 == frame[2])
+            {
+                event->type = NEX_EVT_STARTUP;
+                break;
+            }
+            /* fall through */
+        default:
+            if (1 == len && nexIsErrorCode(frame[0]))
+            {
+                event->type = NEX_EVT_ERROR;
+            }
+            break;
+    }
+
+    return NEX_EVT_UNKNOWN != event->type;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file NexEvent.h
+ *
+ * Decoding of frames returned by Nextion into typed events. 
+ *
+ * @copyright 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ */
+#ifndef __NEXEVENT_H__
+#define __NEXEVENT_H__
+
+#include <stdint.h>
+#include "NexParser.h"
+
+/**
+ * @addtogroup CoreAPI 
+ * @{ 
+ */
+
+/**
+ * Kind of frame returned by Nextion. 
+ */
+enum NexEventType
+{
+    NEX_EVT_UNKNOWN = 0,        /**< Unrecognised or malformed frame */
+    NEX_EVT_STARTUP,            /**< 0x00 0x00 0x00, panel powered on */
+    NEX_EVT_CMD_FINISHED,       /**< 0x01, command succeeded (bkcmd=1 or 3) */
+    NEX_EVT_ERROR,              /**< Command failed, code holds the NEX_RET_INVALID_* value */
+    NEX_EVT_TOUCH,              /**< 0x65, component touched */
+    NEX_EVT_PAGE,               /**< 0x66, current page (reply to sendme) */
+    NEX_EVT_POSITION,           /**< 0x67, touch coordinate while awake */
+    NEX_EVT_SLEEP_POSITION,     /**< 0x68, touch coordinate while asleep */
+    NEX_EVT_STRING,             /**< 0x70, string returned by get */
+    NEX_EVT_NUMBER,             /**< 0x71, number returned by get */
+    NEX_EVT_SLEEP,              /**< 0x86, panel entered sleep */
+    NEX_EVT_WAKE,               /**< 0x87, panel woke up */
+    NEX_EVT_READY,              /**< 0x88, panel finished booting */
+    NEX_EVT_UPGRADE,            /**< 0x89, microSD upgrade started */
+    NEX_EVT_TRANSPARENT_READY,  /**< 0xFE, ready for transparent data */
+    NEX_EVT_TRANSPARENT_DONE,   /**< 0xFD, transparent data finished */
+};
+
+/**
+ * A decoded Nextion frame. Only the fields of its type are meaningful. 
+ */
+struct NexEvent
+{
+    NexEventType type;
+    uint8_t code;           /**< Frame header byte */
+    uint8_t page_id;        /**< NEX_EVT_TOUCH, NEX_EVT_PAGE */
+    uint8_t component_id;   /**< NEX_EVT_TOUCH */
+    uint8_t touch;          /**< NEX_EVENT_PUSH or NEX_EVENT_POP */
+    uint16_t x;             /**< NEX_EVT_POSITION, NEX_EVT_SLEEP_POSITION */
+    uint16_t y;             /**< NEX_EVT_POSITION, NEX_EVT_SLEEP_POSITION */
+    uint32_t number;        /**< NEX_EVT_NUMBER */
+    const uint8_t *text;    /**< NEX_EVT_STRING, not terminated, valid during the callback only */
+    uint16_t text_len;      /**< NEX_EVT_STRING */
+};
+
+/**
+ * Type of callback function called for every frame received. 
+ */
+typedef void (*NexEventCb)(const NexEvent *event, void *ptr);
+
+/**
+ * Decode a frame queued by NexParser. 
+ *
+ * @param frame - header and payload, without terminator. 
+ * @param len - length of frame. 
+ * @param event - receives the decoded event. 
+ *
+ * @retval true - frame recognised. 
+ * @retval false - unknown or malformed, event->type is NEX_EVT_UNKNOWN. 
+ */
+bool nexDecodeEvent(const uint8_t *frame, uint16_t len, NexEvent *event);
+
+/**
+ * Whether a return code reports a failed command. 
+ *
+ * @param code - frame header byte. 
+ */
+bool nexIsErrorCode(uint8_t code);
+
+/**
+ * @}
+ */
+
+#endif /* #ifndef __NEXEVENT_H__ */
@@ -29,6 +29,11 @@ bool NexGauge::getValue(uint32_t *number)
     return recvRetNumber(number);
 }
 
+uint16_t NexGauge::getValueAsync(uint32_t *number, NexCmdCb cb, void *ptr)
+{
+    return nexGetNumber(getObjName(), "val", number, cb, ptr);
+}
+
 bool NexGauge::setValue(uint32_t number)
 {
     char buf[10] = {0};
@@ -14,24 +14,6 @@
  */
 #include "NexHardware.h"
 
-#define NEX_RET_CMD_FINISHED            (0x01)
-#define NEX_RET_EVENT_LAUNCHED          (0x88)
-#define NEX_RET_EVENT_UPGRADED          (0x89)
-#define NEX_RET_EVENT_TOUCH_HEAD            (0x65)     
-#define NEX_RET_EVENT_POSITION_HEAD         (0x67)
-#define NEX_RET_EVENT_SLEEP_POSITION_HEAD   (0x68)
-#define NEX_RET_CURRENT_PAGE_ID_HEAD        (0x66)
-#define NEX_RET_STRING_HEAD                 (0x70)
-#define NEX_RET_NUMBER_HEAD                 (0x71)
-#define NEX_RET_INVALID_CMD             (0x00)
-#define NEX_RET_INVALID_COMPONENT_ID    (0x02)
-#define NEX_RET_INVALID_PAGE_ID         (0x03)
-#define NEX_RET_INVALID_PICTURE_ID      (0x04)
-#define NEX_RET_INVALID_FONT_ID         (0x05)
-#define NEX_RET_INVALID_BAUD            (0x11)
-#define NEX_RET_INVALID_VARIABLE        (0x1A)
-#define NEX_RET_INVALID_OPERATION       (0x1B)
-
 /*
  * Receive uint32_t data. 
  * 
@@ -99,7 +81,6 @@ uint16_t recvRetString(char *buffer, uint16_t len, uint32_t timeout)
     uint16_t ret = 0;
     bool str_start_flag = false;
     uint8_t cnt_0xff = 0;
-    String temp = String("");
     uint8_t c = 0;
     long start;
 
@@ -124,9 +105,9 @@ uint16_t recvRetString(char *buffer, uint16_t len, uint32_t timeout)
                         break;
                     }
                 }
-                else
+                else if (ret < len)
                 {
-                    temp += (char)c;
+                    buffer[ret++] = (char)c;
                 }
             }
             else if (NEX_RET_STRING_HEAD == c)
@@ -141,21 +122,55 @@ uint16_t recvRetString(char *buffer, uint16_t len, uint32_t timeout)
         }
     }
 
-    ret = temp.length();
-    ret = ret > len ? len : ret;
-    strncpy(buffer, temp.c_str(), ret);
-    
 __return:
 
     dbSerialPrint("recvRetString[");
-    dbSerialPrint(temp.length());
-    dbSerialPrint(",");
-    dbSerialPrint(temp);
+    dbSerialPrint(ret);
     dbSerialPrintln("]");
 
     return ret;
 }
 
+static NexParser __parser;
+static uint32_t __baud = NEX_DEFAULT_BAUD;
+
+/*
+ * Link traffic. The bytes moved since nexSerial was last opened are turned 
+ * into wire time at its rate when it is reopened or the stats are read.
+ */
+static uint32_t __tx_bytes = 0;
+static uint32_t __rx_bytes = 0;
+static uint32_t __tx_commands = 0;
+static uint32_t __rate_tx_bytes = 0;
+static uint32_t __rate_rx_bytes = 0;
+static uint64_t __tx_wire_us = 0;
+static uint64_t __rx_wire_us = 0;
+
+static void nexCountTx(uint32_t len)
+{
+    __tx_bytes += len;
+    __rate_tx_bytes += len;
+}
+
+static void nexFeedParser(void)
+{
+    while (nexSerial.available() > 0)
+    {
+        __parser.feed((uint8_t)nexSerial.read());
+        __rx_bytes++;
+        __rate_rx_bytes++;
+    }
+}
+
+static void nexFoldWireTime(void)
+{
+    /* 8N1: a start and a stop bit around every byte */
+    __tx_wire_us += (uint64_t)__rate_tx_bytes * 10 * 1000000 / __baud;
+    __rx_wire_us += (uint64_t)__rate_rx_bytes * 10 * 1000000 / __baud;
+    __rate_tx_bytes = 0;
+    __rate_rx_bytes = 0;
+}
+
 /*
  * Send command to Nextion.
  *
@@ -163,15 +178,15 @@ __return:
  */
 void sendCommand(const char* cmd)
 {
-    while (nexSerial.available())
-    {
-        nexSerial.read();
-    }
+    /* Keep events received meanwhile for nexLoop instead of discarding them */
+    nexFeedParser();
     
     nexSerial.print(cmd);
     nexSerial.write(0xFF);
     nexSerial.write(0xFF);
     nexSerial.write(0xFF);
+    nexCountTx(strlen(cmd) + 3);
+    __tx_commands++;
 }
 
 
@@ -217,51 +232,635 @@ bool recvRetCommandFinished(uint32_t timeout)
 }
 
 
+static void nexFailPending(void);
+
+/*
+ * Open nexSerial at baud, on its alternate pins if NEX_SERIAL_SWAP is defined 
+ * (begin puts UART0 back on the default ones).
+ */
+static void nexSerialBegin(uint32_t baud)
+{
+    nexFoldWireTime();
+    nexSerial.begin(baud);
+#ifdef NEX_SERIAL_SWAP
+    nexSerial.swap();
+#endif
+}
+
 bool nexInit(void)
 {
     bool ret1 = false;
     bool ret2 = false;
     
-    dbSerialBegin(9600);
-    nexSerial.begin(9600);
+    /* The handshake below reads replies directly, nothing queued can be matched */
+    nexFailPending();
+
+    dbSerialBegin(NEX_DEFAULT_BAUD);
+    nexSerialBegin(NEX_DEFAULT_BAUD);
+    __baud = NEX_DEFAULT_BAUD;
     sendCommand("");
-    sendCommand("bkcmd=1");
+    sendCommand("bkcmd=3");
     ret1 = recvRetCommandFinished();
     sendCommand("page 0");
     ret2 = recvRetCommandFinished();
+    __parser.reset();
     return ret1 && ret2;
 }
 
-void nexLoop(NexTouch *nex_listen_list[])
+/*
+ * Reopen nexSerial at baud and throw away whatever was received during the
+ * switch, it was sent at the other rate.
+ */
+static void nexReopen(uint32_t baud)
 {
-    static uint8_t __buffer[10];
+    nexSerial.flush();
+    nexSerialBegin(baud);
+    __baud = baud;
+    delay(NEX_BAUD_SETTLE);
     
-    uint16_t i;
-    uint8_t c;  
+    while (nexSerial.available())
+    {
+        nexSerial.read();
+    }
+    __parser.reset();
+}
+
+bool nexSetBaud(uint32_t baud)
+{
+    char cmd[16];
+    uint32_t prev = __baud;
+    bool ret = false;
+
+    nexFailPending();
+
+    snprintf(cmd, sizeof(cmd), "baud=%lu", (unsigned long)baud);
+    sendCommand(cmd);
+    nexReopen(baud);
     
-    while (nexSerial.available() > 0)
-    {   
-        delay(10);
+    sendCommand("bkcmd=3");
+    ret = recvRetCommandFinished();
+    
+    if (!ret && prev != baud)
+    {
+        snprintf(cmd, sizeof(cmd), "baud=%lu", (unsigned long)prev);
+        sendCommand(cmd);
+        nexReopen(prev);
+    }
+
+    dbSerialPrint("nexSetBaud ");
+    dbSerialPrintln(__baud);
+    return ret;
+}
+
+uint32_t nexGetBaud(void)
+{
+    return __baud;
+}
+
+/*
+ * Wait for the "comok" reply to connect, skipping the replies to the commands 
+ * sent before it.
+ */
+static bool nexRecvComok(uint32_t timeout)
+{
+    char frame[8];
+    uint8_t len = 0;
+    uint8_t cnt_0xff = 0;
+    uint8_t c;
+    uint32_t start = millis();
+
+    while (millis() - start <= timeout)
+    {
+        if (!nexSerial.available())
+        {
+            yield();
+            continue;
+        }
         c = nexSerial.read();
-        
-        if (NEX_RET_EVENT_TOUCH_HEAD == c)
+        if (0xFF == c)
         {
-            if (nexSerial.available() >= 6)
+            if (++cnt_0xff >= 3)
             {
-                __buffer[0] = c;  
-                for (i = 1; i < 7; i++)
-                {
-                    __buffer[i] = nexSerial.read();
-                }
-                __buffer[i] = 0x00;
-                
-                if (0xFF == __buffer[4] && 0xFF == __buffer[5] && 0xFF == __buffer[6])
+                if (len >= 5 && 0 == strncmp(frame, "comok", 5))
                 {
-                    NexTouch::iterate(nex_listen_list, __buffer[1], __buffer[2], (int32_t)__buffer[3]);
+                    return true;
                 }
-                
+                len = 0;
+                cnt_0xff = 0;
+            }
+            continue;
+        }
+        cnt_0xff = 0;
+        if (len < sizeof(frame))
+        {
+            frame[len++] = (char)c;
+        }
+    }
+    return false;
+}
+
+/*
+ * Wait for the panel to acknowledge upload data with 0x05.
+ */
+static bool nexRecvUploadAck(uint32_t timeout)
+{
+    uint32_t start = millis();
+
+    while (millis() - start <= timeout)
+    {
+        if (nexSerial.available())
+        {
+            if (0x05 == nexSerial.read())
+            {
+                return true;
+            }
+        }
+        else
+        {
+            yield();
+        }
+    }
+    return false;
+}
+
+bool nexUploadTft(Stream &source, uint32_t size, uint32_t baud, NexUploadCb cb, void *ptr)
+{
+    char cmd[40];
+    uint8_t buffer[NEX_UPLOAD_COPY_SIZE];
+    uint32_t sent = 0;
+    uint32_t chunk_end;
+    uint16_t len;
+    bool ret = false;
+
+    nexFailPending();
+    while (nexSerial.available())
+    {
+        nexSerial.read();
+    }
+    __parser.reset();
+
+    /* End whatever the panel was receiving, wake it and ask for upload mode */
+    sendCommand("DRAKJHSUYDGBNCJHGJKSHBDN");
+    sendCommand("sleep=0");
+    sendCommand("connect");
+    if (!nexRecvComok(NEX_CMD_TIMEOUT))
+    {
+        dbSerialPrintln("nexUploadTft no comok");
+        return false;
+    }
+
+    snprintf(cmd, sizeof(cmd), "whmi-wri %lu,%lu,0", (unsigned long)size, (unsigned long)baud);
+    sendCommand(cmd);
+    nexSerial.flush();
+    nexSerialBegin(baud);
+    if (!nexRecvUploadAck(NEX_UPLOAD_ACK_TIMEOUT))
+    {
+        goto __return;
+    }
+
+    while (sent < size)
+    {
+        chunk_end = (size - sent > NEX_UPLOAD_CHUNK) ? sent + NEX_UPLOAD_CHUNK : size;
+        while (sent < chunk_end)
+        {
+            len = (chunk_end - sent > sizeof(buffer)) ? sizeof(buffer) : chunk_end - sent;
+            len = source.readBytes(buffer, len);
+            if (0 == len)
+            {
+                goto __return; /* Source ran dry or timed out */
+            }
+            nexSerial.write(buffer, len);
+            sent += len;
+        }
+        if (!nexRecvUploadAck(NEX_UPLOAD_ACK_TIMEOUT))
+        {
+            goto __return;
+        }
+        if (cb)
+        {
+            cb(sent, size, ptr);
+        }
+    }
+    ret = true;
+
+__return:
+
+    nexSerial.flush();
+    nexSerialBegin(NEX_DEFAULT_BAUD);
+    __baud = NEX_DEFAULT_BAUD;
+    __parser.reset();
+
+    dbSerialPrint("nexUploadTft ");
+    dbSerialPrintln(sent);
+    return ret;
+}
+
+static NexEventCb __cb_event = NULL;
+static void *__cbevent_ptr = NULL;
+
+void nexAttachEvent(NexEventCb cb, void *ptr)
+{
+    __cb_event = cb;
+    __cbevent_ptr = ptr;
+}
+
+void nexDetachEvent(void)
+{
+    __cb_event = NULL;
+    __cbevent_ptr = NULL;
+}
+
+/*
+ * Commands queued by nexSendCommand/nexGetString/nexGetNumber, oldest first.
+ */
+#define NEX_CMD_KIND_ACK        (0)
+#define NEX_CMD_KIND_STRING     (1)
+#define NEX_CMD_KIND_NUMBER     (2)
+#define NEX_CMD_KIND_PAGE       (3)
+#define NEX_CMD_KIND_TRANSPARENT        (4) /* addt sent, waiting for 0xFE */
+#define NEX_CMD_KIND_TRANSPARENT_DATA   (5) /* data sent, waiting for 0xFD */
+
+struct NexPendingCmd
+{
+    uint16_t tag;
+    uint8_t kind;
+    void *dest;
+    uint16_t dest_len;
+    NexCmdCb cb;
+    void *ptr;
+    uint32_t sent;
+};
+
+static NexPendingCmd __pending[NEX_CMD_QUEUE_SIZE];
+static uint8_t __pending_head = 0;
+static uint8_t __pending_count = 0;
+static uint16_t __next_tag = 0;
+static NexCmdCb __cb_cmd_error = NULL;
+static void *__cbcmderror_ptr = NULL;
+static uint8_t __transparent_count = 0;
+static NexTouch **__listen_list = NULL;
+static NexTouchTable __touch_table;
+static bool __touch_table_built = false;
+
+static void nexCompleteCommand(bool ok, uint8_t code)
+{
+    NexPendingCmd cmd = __pending[__pending_head];
+
+    __pending_head = (__pending_head + 1) % NEX_CMD_QUEUE_SIZE;
+    __pending_count--;
+    if (NEX_CMD_KIND_TRANSPARENT == cmd.kind || NEX_CMD_KIND_TRANSPARENT_DATA == cmd.kind)
+    {
+        __transparent_count--;
+    }
+
+    if (cmd.cb)
+    {
+        cmd.cb(cmd.tag, ok, code, cmd.ptr);
+    }
+    if (!ok && __cb_cmd_error)
+    {
+        __cb_cmd_error(cmd.tag, ok, code, __cbcmderror_ptr);
+    }
+}
+
+static void nexFailPending(void)
+{
+    while (__pending_count > 0)
+    {
+        nexCompleteCommand(false, NEX_RET_CMD_TIMEOUT);
+    }
+}
+
+/*
+ * Advance the transparent transfer at the head of the queue: send its data 
+ * once the panel is ready for it, complete it once the panel has taken it all.
+ *
+ * @return true if the event belonged to the transfer.
+ */
+static bool nexMatchTransparent(const NexEvent *event)
+{
+    NexPendingCmd *cmd = &__pending[__pending_head];
+
+    if (0 == __pending_count)
+    {
+        return false;
+    }
+    if (NEX_EVT_TRANSPARENT_READY == event->type && NEX_CMD_KIND_TRANSPARENT == cmd->kind)
+    {
+        nexSerial.write((const uint8_t *)cmd->dest, cmd->dest_len);
+        nexCountTx(cmd->dest_len);
+        cmd->kind = NEX_CMD_KIND_TRANSPARENT_DATA;
+        cmd->sent = millis();
+        return true;
+    }
+    if (NEX_EVT_TRANSPARENT_DONE == event->type && NEX_CMD_KIND_TRANSPARENT_DATA == cmd->kind)
+    {
+        nexCompleteCommand(true, event->code);
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Match a reply with the oldest queued command.
+ *
+ * @return true if the event was a reply.
+ */
+static bool nexMatchReply(const NexEvent *event)
+{
+    NexPendingCmd *cmd;
+    uint16_t n;
+    bool ok = false;
+
+    switch (event->type)
+    {
+        case NEX_EVT_CMD_FINISHED:
+        case NEX_EVT_ERROR:
+        case NEX_EVT_STRING:
+        case NEX_EVT_NUMBER:
+            break;
+        case NEX_EVT_PAGE:
+            /* Also sent unprompted by HMIs that run sendme on page entry */
+            if (0 == __pending_count || NEX_CMD_KIND_PAGE != __pending[__pending_head].kind)
+            {
+                return false;
+            }
+            break;
+        case NEX_EVT_TRANSPARENT_READY:
+        case NEX_EVT_TRANSPARENT_DONE:
+            return nexMatchTransparent(event);
+        default:
+            return false;
+    }
+    if (0 == __pending_count)
+    {
+        return true;
+    }
+
+    cmd = &__pending[__pending_head];
+    switch (cmd->kind)
+    {
+        case NEX_CMD_KIND_ACK:
+            ok = (NEX_EVT_CMD_FINISHED == event->type);
+            break;
+        case NEX_CMD_KIND_STRING:
+            ok = (NEX_EVT_STRING == event->type);
+            if (ok)
+            {
+                n = event->text_len < cmd->dest_len ? event->text_len : cmd->dest_len - 1;
+                memcpy(cmd->dest, event->text, n);
+                ((char *)cmd->dest)[n] = '\0';
+            }
+            break;
+        case NEX_CMD_KIND_NUMBER:
+            ok = (NEX_EVT_NUMBER == event->type);
+            if (ok)
+            {
+                *(uint32_t *)cmd->dest = event->number;
+            }
+            break;
+        case NEX_CMD_KIND_PAGE:
+            ok = (NEX_EVT_PAGE == event->type);
+            if (ok && cmd->dest)
+            {
+                *(uint8_t *)cmd->dest = event->page_id;
+            }
+            break;
+        case NEX_CMD_KIND_TRANSPARENT:
+        case NEX_CMD_KIND_TRANSPARENT_DATA:
+            if (NEX_EVT_CMD_FINISHED == event->type)
+            {
+                return true; /* Some firmware also acknowledges addt itself */
+            }
+            break;
+    }
+    nexCompleteCommand(ok, event->code);
+    return true;
+}
+
+/*
+ * Reserve a queue entry for a command about to be written.
+ *
+ * Replies are matched to commands in order, so a full queue refuses the new 
+ * command rather than dropping an older entry whose reply is still on its way.
+ *
+ * @return its tag, 0 if NEX_CMD_QUEUE_SIZE commands already await their reply.
+ */
+static uint16_t nexQueueCommand(uint8_t kind, void *dest, uint16_t dest_len, NexCmdCb cb, void *ptr)
+{
+    NexPendingCmd *pending;
+
+    if (NEX_CMD_QUEUE_SIZE == __pending_count)
+    {
+        return 0;
+    }
+
+    if (0 == ++__next_tag)
+    {
+        __next_tag = 1;
+    }
+
+    pending = &__pending[(__pending_head + __pending_count) % NEX_CMD_QUEUE_SIZE];
+    pending->tag = __next_tag;
+    pending->kind = kind;
+    pending->dest = dest;
+    pending->dest_len = dest_len;
+    pending->cb = cb;
+    pending->ptr = ptr;
+    pending->sent = millis();
+    __pending_count++;
+
+    return __next_tag;
+}
+
+static void nexProcess(void);
+
+/*
+ * Block until no transparent transfer is in progress: while one is, the panel 
+ * takes every byte it receives as transfer data. Bounded by NEX_CMD_TIMEOUT 
+ * per queued command.
+ */
+static void nexWaitTransparent(void)
+{
+    while (__transparent_count > 0)
+    {
+        nexProcess();
+        yield();
+    }
+}
+
+static uint16_t nexWriteCommand(const char *cmd, uint8_t kind, void *dest, uint16_t dest_len,
+                                NexCmdCb cb, void *ptr)
+{
+    uint16_t tag;
+
+    nexWaitTransparent();
+    tag = nexQueueCommand(kind, dest, dest_len, cb, ptr);
+    if (0 == tag)
+    {
+        return 0;
+    }
+
+    nexSerial.print(cmd);
+    nexSerial.write(0xFF);
+    nexSerial.write(0xFF);
+    nexSerial.write(0xFF);
+    nexCountTx(strlen(cmd) + 3);
+    __tx_commands++;
+
+    return tag;
+}
+
+uint16_t nexSendCommand(const char *cmd, NexCmdCb cb, void *ptr)
+{
+    return nexWriteCommand(cmd, NEX_CMD_KIND_ACK, NULL, 0, cb, ptr);
+}
+
+uint16_t nexSendBuffer(const uint8_t *buffer, uint16_t len, NexCmdCb cb, void *ptr)
+{
+    uint16_t tag;
+
+    nexWaitTransparent();
+    tag = nexQueueCommand(NEX_CMD_KIND_ACK, NULL, 0, cb, ptr);
+    if (0 == tag)
+    {
+        return 0;
+    }
+
+    nexSerial.write(buffer, len);
+    nexCountTx(len);
+    __tx_commands++;
+    return tag;
+}
+
+uint16_t nexGetString(const char *name, const char *attr, char *buffer, uint16_t len,
+                      NexCmdCb cb, void *ptr)
+{
+    char cmd[NEX_PARSER_FRAME_MAX];
+
+    if (!buffer || 0 == len)
+    {
+        return 0;
+    }
+    if (snprintf(cmd, sizeof(cmd), "get %s.%s", name, attr) >= (int)sizeof(cmd))
+    {
+        return 0;
+    }
+    return nexWriteCommand(cmd, NEX_CMD_KIND_STRING, buffer, len, cb, ptr);
+}
+
+uint16_t nexGetNumber(const char *name, const char *attr, uint32_t *number,
+                      NexCmdCb cb, void *ptr)
+{
+    char cmd[NEX_PARSER_FRAME_MAX];
+
+    if (!number)
+    {
+        return 0;
+    }
+    if (snprintf(cmd, sizeof(cmd), "get %s.%s", name, attr) >= (int)sizeof(cmd))
+    {
+        return 0;
+    }
+    return nexWriteCommand(cmd, NEX_CMD_KIND_NUMBER, number, 0, cb, ptr);
+}
+
+uint16_t nexSendTransparent(const char *cmd, const uint8_t *data, uint16_t len,
+                            NexCmdCb cb, void *ptr)
+{
+    uint16_t tag = nexWriteCommand(cmd, NEX_CMD_KIND_TRANSPARENT, (void *)data, len, cb, ptr);
+
+    if (tag)
+    {
+        __transparent_count++;
+    }
+    return tag;
+}
+
+bool nexTransparentActive(void)
+{
+    return __transparent_count > 0;
+}
+
+uint16_t nexGetPage(uint8_t *page_id, NexCmdCb cb, void *ptr)
+{
+    return nexWriteCommand("sendme", NEX_CMD_KIND_PAGE, page_id, 0, cb, ptr);
+}
+
+void nexAttachCmdError(NexCmdCb cb, void *ptr)
+{
+    __cb_cmd_error = cb;
+    __cbcmderror_ptr = ptr;
+}
+
+uint8_t nexPendingCommands(void)
+{
+    return __pending_count;
+}
+
+void nexGetLinkStats(NexLinkStats *stats)
+{
+    nexFoldWireTime();
+    stats->tx_bytes = __tx_bytes;
+    stats->rx_bytes = __rx_bytes;
+    stats->tx_commands = __tx_commands;
+    stats->tx_wire_ms = __tx_wire_us / 1000;
+    stats->rx_wire_ms = __rx_wire_us / 1000;
+}
+
+void nexLoop(NexTouch *nex_listen_list[])
+{
+    if (nex_listen_list != __listen_list)
+    {
+        /* Falls back to scanning the list if it does not fit the table */
+        __touch_table_built = __touch_table.build(nex_listen_list);
+        __listen_list = nex_listen_list;
+    }
+    nexProcess();
+}
+
+void nexRebuildTouchTable(void)
+{
+    __touch_table_built = __touch_table.build(__listen_list);
+}
+
+static void nexProcess(void)
+{
+    uint8_t frame[NEX_PARSER_FRAME_MAX];
+    uint16_t len;
+    NexEvent event;
+    
+    nexFeedParser();
+
+    while ((len = __parser.read(frame, sizeof(frame))) > 0)
+    {
+        if (!nexDecodeEvent(frame, len, &event))
+        {
+            dbSerialPrint("nexLoop unknown frame 0x");
+            dbSerialPrintln(frame[0]);
+            continue;
+        }
+        
+        if (!nexMatchReply(&event) && NEX_EVT_TOUCH == event.type)
+        {
+            if (__touch_table_built)
+            {
+                __touch_table.dispatch(event.page_id, event.component_id, (int32_t)event.touch);
+            }
+            else
+            {
+                NexTouch::iterate(__listen_list, event.page_id, event.component_id, (int32_t)event.touch);
             }
         }
+        if (__cb_event)
+        {
+            __cb_event(&event, __cbevent_ptr);
+        }
+    }
+
+    while (__pending_count > 0 && millis() - __pending[__pending_head].sent >= NEX_CMD_TIMEOUT)
+    {
+        nexCompleteCommand(false, NEX_RET_CMD_TIMEOUT);
     }
 }
 
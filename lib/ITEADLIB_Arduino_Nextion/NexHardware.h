@@ -16,6 +16,8 @@
 #define __NEXHARDWARE_H__
 #include <Arduino.h>
 #include "NexConfig.h"
+#include "NexParser.h"
+#include "NexEvent.h"
 #include "NexTouch.h"
 
 /**
@@ -30,10 +32,68 @@
  */
 bool nexInit(void);
 
+/**
+ * Switch Nextion and nexSerial to another baud rate. 
+ *
+ * The baud command is sent at the current rate, nexSerial is reopened at the 
+ * new one and a command is sent to confirm Nextion followed. If it did not 
+ * answer, the previous rate is restored. Queued commands are failed first, 
+ * their replies would be lost in the switch. 
+ *
+ * @param baud - the new rate, such as 115200. 
+ * @return true if Nextion answered at the new rate, false for failure. 
+ *
+ * @warning Blocks for about NEX_BAUD_SETTLE plus one reply, call it during 
+ *  initialisation or recovery only. 
+ */
+bool nexSetBaud(uint32_t baud);
+
+/**
+ * The baud rate nexSerial currently talks to Nextion at. 
+ */
+uint32_t nexGetBaud(void);
+
+/**
+ * Type of callback function called as a TFT upload progresses. 
+ *
+ * @param sent - bytes the panel has acknowledged so far. 
+ * @param total - size of the TFT file. 
+ * @param ptr - parameter given to nexUploadTft. 
+ */
+typedef void (*NexUploadCb)(uint32_t sent, uint32_t total, void *ptr);
+
+/**
+ * Upload a TFT file to Nextion with the whmi-wri protocol, streaming it from 
+ * source as the panel takes it. 
+ *
+ * Only NEX_UPLOAD_COPY_SIZE bytes are held at a time; the panel acknowledges 
+ * every NEX_UPLOAD_CHUNK bytes with 0x05 before the next are sent. Queued 
+ * commands are failed first. Nextion draws its own progress bar meanwhile. 
+ *
+ * @param source - the TFT file, such as the body of an HTTP response. 
+ * @param size - length of the TFT file in bytes. 
+ * @param baud - rate the file is sent at, such as 115200. 
+ * @param cb - called after every acknowledged chunk[default:NULL]. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return true if the panel took the whole file, false for failure. 
+ *
+ * @warning Blocks for the whole upload. Once it started, nexSerial is left at 
+ *  NEX_DEFAULT_BAUD whatever the result: Nextion restarts with the new HMI, 
+ *  or stays waiting for the rest of the file until it is power cycled. Call 
+ *  nexInit again afterwards. 
+ */
+bool nexUploadTft(Stream &source, uint32_t size, uint32_t baud, NexUploadCb cb = NULL, void *ptr = NULL);
+
 /**
  * Listen touch event and calling callbacks attached before.
  * 
- * Supports push and pop at present. 
+ * Supports push and pop at present. Reads only the bytes already received 
+ * and returns without waiting; a frame split across calls is completed 
+ * on a later call. 
+ *
+ * Touch events are dispatched through a NexTouchTable built from 
+ * nex_listen_list the first time it is passed in, so finding the component 
+ * does not depend on the length of the list. 
  *
  * @param nex_listen_list - index to Nextion Components list. 
  * @return none. 
@@ -43,6 +103,188 @@ bool nexInit(void);
  */
 void nexLoop(NexTouch *nex_listen_list[]);
 
+/**
+ * Rebuild the touch dispatch table after the listen list last passed to 
+ * nexLoop was changed in place. 
+ *
+ * @return none. 
+ */
+void nexRebuildTouchTable(void);
+
+/**
+ * Attach a callback function called by nexLoop for every frame received 
+ * (page changes, sleep and wake, touch coordinates, command results...). 
+ * Touch events are passed to it as well as to the listen list. 
+ *
+ * @param cb - callback called with the decoded event and ptr. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return none. 
+ *
+ * @note If calling this method multiply, the last call is valid. 
+ */
+void nexAttachEvent(NexEventCb cb, void *ptr = NULL);
+
+/**
+ * Detach the callback function attached by nexAttachEvent. 
+ *
+ * @return none. 
+ */
+void nexDetachEvent(void);
+
+/**
+ * Result code passed to NexCmdCb when no reply arrived within NEX_CMD_TIMEOUT. 
+ */
+#define NEX_RET_CMD_TIMEOUT     (0xFF)
+
+/**
+ * Type of callback function called when a queued command completes. 
+ *
+ * @param tag - the tag returned when the command was queued. 
+ * @param ok - true if the command succeeded. 
+ * @param code - header of the reply (NEX_RET_CMD_FINISHED, NEX_RET_STRING_HEAD, 
+ *  NEX_RET_NUMBER_HEAD, NEX_RET_CURRENT_PAGE_ID_HEAD, NEX_RET_TRANSPARENT_FINISHED, 
+ *  a NEX_RET_INVALID_* code) or NEX_RET_CMD_TIMEOUT. 
+ * @param ptr - parameter given when the command was queued. 
+ */
+typedef void (*NexCmdCb)(uint16_t tag, bool ok, uint8_t code, void *ptr);
+
+/**
+ * Send a command without waiting for its reply. 
+ * 
+ * The reply is matched by nexLoop and reported to cb. Replies come back in 
+ * the order commands were sent, which requires bkcmd=3 (set by nexInit). 
+ * While NEX_CMD_QUEUE_SIZE commands await their reply, a new command is 
+ * refused: nothing is sent and cb is not called. Dropping an older entry 
+ * instead would hand its reply to the wrong command. 
+ *
+ * @param cmd - the command, without terminator. 
+ * @param cb - called with the result[default:NULL]. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return tag identifying the command, 0 if the command was refused. 
+ *
+ * @warning Do not mix with the blocking recvRet* functions while commands 
+ *  are queued, they would consume the queued replies. 
+ */
+uint16_t nexSendCommand(const char *cmd, NexCmdCb cb = NULL, void *ptr = NULL);
+
+/**
+ * Send a command already terminated with 0xFF 0xFF 0xFF, in a single write, 
+ * without waiting for its reply. 
+ *
+ * @param buffer - the command and its terminator. 
+ * @param len - length of buffer. 
+ * @param cb - called with the result[default:NULL]. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return tag identifying the command, 0 if the command was refused. 
+ *
+ * @see nexSendCommand
+ */
+uint16_t nexSendBuffer(const uint8_t *buffer, uint16_t len, NexCmdCb cb = NULL, void *ptr = NULL);
+
+/**
+ * Read a string attribute without waiting for it. 
+ *
+ * @param name - component name. 
+ * @param attr - attribute name, such as "txt". 
+ * @param buffer - receives the text terminated with '\0' once the reply arrives. 
+ *  Must stay valid until cb is called. 
+ * @param len - length of buffer. 
+ * @param cb - called with the result[default:NULL]. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return tag identifying the command, 0 if the command does not fit or 
+ *  was refused. 
+ */
+uint16_t nexGetString(const char *name, const char *attr, char *buffer, uint16_t len,
+                      NexCmdCb cb = NULL, void *ptr = NULL);
+
+/**
+ * Read a numeric attribute without waiting for it. 
+ *
+ * @param name - component name. 
+ * @param attr - attribute name, such as "val". 
+ * @param number - receives the value once the reply arrives. Must stay valid 
+ *  until cb is called. 
+ * @param cb - called with the result[default:NULL]. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return tag identifying the command, 0 if the command does not fit or 
+ *  was refused. 
+ */
+uint16_t nexGetNumber(const char *name, const char *attr, uint32_t *number,
+                      NexCmdCb cb = NULL, void *ptr = NULL);
+
+/**
+ * Send a command that switches the panel to transparent data mode (such as 
+ * addt), then its data once the panel is ready, without waiting. 
+ *
+ * Commands sent while a transfer is in progress wait for it to finish, since 
+ * the panel would take them as transfer data. 
+ *
+ * @param cmd - the command, without terminator. 
+ * @param data - the data sent after the panel replied 0xFE. Must stay valid 
+ *  until cb is called. 
+ * @param len - length of data. 
+ * @param cb - called with the result once the panel replied 0xFD[default:NULL]. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return tag identifying the command, 0 if the command was refused. 
+ */
+uint16_t nexSendTransparent(const char *cmd, const uint8_t *data, uint16_t len,
+                            NexCmdCb cb = NULL, void *ptr = NULL);
+
+/**
+ * Whether a transparent transfer is queued or in progress. 
+ */
+bool nexTransparentActive(void);
+
+/**
+ * Ask the panel for its current page (sendme) without waiting for it. 
+ *
+ * The reply is also passed to the nexAttachEvent callback as NEX_EVT_PAGE. 
+ *
+ * @param page_id - receives the page id once the reply arrives, may be NULL. 
+ * @param cb - called with the result[default:NULL]. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return tag identifying the command, 0 if the command was refused. 
+ */
+uint16_t nexGetPage(uint8_t *page_id = NULL, NexCmdCb cb = NULL, void *ptr = NULL);
+
+/**
+ * Attach a callback function called for every queued command that fails, 
+ * in addition to its own callback. 
+ *
+ * @param cb - callback called on failure. 
+ * @param ptr - parameter passed into cb[default:NULL]. 
+ * @return none. 
+ *
+ * @note If calling this method multiply, the last call is valid. 
+ */
+void nexAttachCmdError(NexCmdCb cb, void *ptr = NULL);
+
+/**
+ * Number of queued commands still waiting for their reply. 
+ */
+uint8_t nexPendingCommands(void);
+
+/**
+ * Traffic on the link since power on: the commands sent and the frames read 
+ * by nexLoop. TFT uploads are not counted. 
+ */
+struct NexLinkStats
+{
+    uint32_t tx_bytes;      /**< Bytes sent to Nextion, terminators and transparent data included */
+    uint32_t rx_bytes;      /**< Bytes received from Nextion */
+    uint32_t tx_commands;   /**< Commands sent */
+    uint32_t tx_wire_ms;    /**< Time the sent bytes kept the line busy, at the rate each went out at */
+    uint32_t rx_wire_ms;    /**< Time the received bytes kept the line busy */
+};
+
+/**
+ * Read the link traffic counters. 
+ *
+ * @param stats - receives the counters. 
+ * @return none. 
+ */
+void nexGetLinkStats(NexLinkStats *stats);
+
 /**
  * @}
  */
@@ -0,0 +1,197 @@
+/**
+ * @file NexParser.cpp
+ *
+ * The implementation of class NexParser. 
+ *
+ * @copyright 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ */
+#include "NexParser.h"
+
+#define NEX_TERMINATOR_LEN  (3)
+
+NexParser::NexParser(void)
+{
+    __dropped = 0;
+    reset();
+}
+
+void NexParser::reset(void)
+{
+    __frame_len = 0;
+    __expect = 0;
+    __ff_count = 0;
+    __discard = false;
+    __head = 0;
+    __used = 0;
+    __frames = 0;
+}
+
+/*
+ * Frames whose payload may itself contain 0xFF have a fixed length and are
+ * delimited by counting, everything else ends at the first 0xFF 0xFF 0xFF.
+ *
+ * @return total length including the terminator, 0 for variable length.
+ */
+uint8_t NexParser::frameLength(uint8_t head)
+{
+    switch (head)
+    {
+        case NEX_RET_CURRENT_PAGE_ID_HEAD:
+            return 5;
+        case NEX_RET_EVENT_TOUCH_HEAD:
+            return 7;
+        case NEX_RET_NUMBER_HEAD:
+            return 8;
+        case NEX_RET_EVENT_POSITION_HEAD:
+        case NEX_RET_EVENT_SLEEP_POSITION_HEAD:
+            return 9;
+        default:
+            return 0;
+    }
+}
+
+bool NexParser::feed(uint8_t c)
+{
+    __ff_count = (0xFF == c) ? __ff_count + 1 : 0;
+
+    if (__discard)
+    {
+        if (__ff_count >= NEX_TERMINATOR_LEN)
+        {
+            __discard = false;
+            __ff_count = 0;
+        }
+        return false;
+    }
+
+    if (0 == __frame_len)
+    {
+        __expect = frameLength(c);
+    }
+
+    if (__frame_len >= sizeof(__frame))
+    {
+        drop();
+        return false;
+    }
+    __frame[__frame_len++] = c;
+
+    if (__expect)
+    {
+        if (__frame_len < __expect)
+        {
+            return false;
+        }
+        if (__ff_count < NEX_TERMINATOR_LEN)
+        {
+            drop();
+            return false;
+        }
+    }
+    else if (__ff_count < NEX_TERMINATOR_LEN)
+    {
+        return false;
+    }
+
+    complete();
+    return true;
+}
+
+uint16_t NexParser::feed(const uint8_t *data, uint16_t len)
+{
+    uint16_t frames = 0;
+    uint16_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (feed(data[i]))
+        {
+            frames++;
+        }
+    }
+    return frames;
+}
+
+/*
+ * Queue the frame in __frame and start a new one.
+ */
+void NexParser::complete(void)
+{
+    uint16_t len = __frame_len - NEX_TERMINATOR_LEN;
+    uint16_t tail;
+    uint16_t i;
+
+    __frame_len = 0;
+    __ff_count = 0;
+
+    if (0 == len)
+    {
+        return;
+    }
+    if (len + 1 > NEX_PARSER_RING_SIZE - __used)
+    {
+        __dropped++;
+        return;
+    }
+
+    tail = (__head + __used) % NEX_PARSER_RING_SIZE;
+    __ring[tail] = (uint8_t)len;
+    for (i = 0; i < len; i++)
+    {
+        tail = (tail + 1) % NEX_PARSER_RING_SIZE;
+        __ring[tail] = __frame[i];
+    }
+    __used += len + 1;
+    __frames++;
+}
+
+/*
+ * Throw away the frame in __frame and skip input up to the next terminator.
+ * Any 0xFF bytes already seen count towards that terminator.
+ */
+void NexParser::drop(void)
+{
+    __dropped++;
+    __frame_len = 0;
+    __discard = __ff_count < NEX_TERMINATOR_LEN;
+    __ff_count = __discard ? __ff_count : 0;
+}
+
+uint16_t NexParser::read(uint8_t *frame, uint16_t len)
+{
+    uint16_t frame_len;
+    uint16_t i;
+
+    if (0 == __frames)
+    {
+        return 0;
+    }
+
+    frame_len = __ring[__head];
+    for (i = 0; i < frame_len; i++)
+    {
+        if (frame && i < len)
+        {
+            frame[i] = __ring[(__head + 1 + i) % NEX_PARSER_RING_SIZE];
+        }
+    }
+    __head = (__head + frame_len + 1) % NEX_PARSER_RING_SIZE;
+    __used -= frame_len + 1;
+    __frames--;
+
+    return frame_len > len ? len : frame_len;
+}
+
+uint16_t NexParser::available(void)
+{
+    return __frames;
+}
+
+uint32_t NexParser::getDropped(void)
+{
+    return __dropped;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file NexParser.h
+ *
+ * The definition of class NexParser. 
+ *
+ * @copyright 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ */
+#ifndef __NEXPARSER_H__
+#define __NEXPARSER_H__
+
+#include <stdint.h>
+#include "NexConfig.h"
+
+#define NEX_RET_CMD_FINISHED            (0x01)
+#define NEX_RET_EVENT_LAUNCHED          (0x88)
+#define NEX_RET_EVENT_UPGRADED          (0x89)
+#define NEX_RET_EVENT_SLEEP             (0x86)
+#define NEX_RET_EVENT_WAKE              (0x87)
+#define NEX_RET_TRANSPARENT_READY       (0xFE)
+#define NEX_RET_TRANSPARENT_FINISHED    (0xFD)
+#define NEX_RET_EVENT_TOUCH_HEAD            (0x65)     
+#define NEX_RET_EVENT_POSITION_HEAD         (0x67)
+#define NEX_RET_EVENT_SLEEP_POSITION_HEAD   (0x68)
+#define NEX_RET_CURRENT_PAGE_ID_HEAD        (0x66)
+#define NEX_RET_STRING_HEAD                 (0x70)
+#define NEX_RET_NUMBER_HEAD                 (0x71)
+#define NEX_RET_INVALID_CMD             (0x00)
+#define NEX_RET_INVALID_COMPONENT_ID    (0x02)
+#define NEX_RET_INVALID_PAGE_ID         (0x03)
+#define NEX_RET_INVALID_PICTURE_ID      (0x04)
+#define NEX_RET_INVALID_FONT_ID         (0x05)
+#define NEX_RET_INVALID_FILE_OPERATION  (0x06)
+#define NEX_RET_INVALID_CRC             (0x09)
+#define NEX_RET_INVALID_BAUD            (0x11)
+#define NEX_RET_INVALID_WAVEFORM        (0x12)
+#define NEX_RET_INVALID_VARIABLE        (0x1A)
+#define NEX_RET_INVALID_OPERATION       (0x1B)
+#define NEX_RET_ASSIGNMENT_FAILED       (0x1C)
+#define NEX_RET_EEPROM_FAILED           (0x1D)
+#define NEX_RET_INVALID_PARAM_COUNT     (0x1E)
+#define NEX_RET_IO_FAILED               (0x1F)
+#define NEX_RET_INVALID_ESCAPE          (0x20)
+#define NEX_RET_NAME_TOO_LONG           (0x23)
+#define NEX_RET_BUFFER_OVERFLOW         (0x24)
+
+/**
+ * @addtogroup CoreAPI 
+ * @{ 
+ */
+
+/**
+ * Incremental parser for frames returned by Nextion. 
+ *
+ * Bytes are fed one at a time as they arrive, the parser never waits for 
+ * more input. Every complete frame (ending in 0xFF 0xFF 0xFF) is queued in 
+ * a ring buffer with its terminator stripped, and popped later with read(). 
+ * It does not touch any serial port; the caller feeds it. 
+ */
+class NexParser
+{
+public: /* methods */
+
+    /**
+     * Constructor. 
+     */
+    NexParser(void);
+
+    /**
+     * Discard the partial frame and every queued frame. 
+     * 
+     * @return none. 
+     */
+    void reset(void);
+
+    /**
+     * Consume one received byte. 
+     *
+     * @param c - the byte. 
+     * @return true if c completed a frame, false otherwise. 
+     */
+    bool feed(uint8_t c);
+
+    /**
+     * Consume a block of received bytes. 
+     *
+     * @param data - the bytes. 
+     * @param len - number of bytes. 
+     * @return number of frames completed. 
+     */
+    uint16_t feed(const uint8_t *data, uint16_t len);
+
+    /**
+     * Pop the oldest queued frame. 
+     *
+     * @param frame - buffer receiving header and payload, without terminator. 
+     * @param len - length of frame buffer. 
+     * @return length of the frame, 0 if none is queued. A frame longer than 
+     *  len is truncated. 
+     */
+    uint16_t read(uint8_t *frame, uint16_t len);
+
+    /**
+     * Number of frames queued. 
+     */
+    uint16_t available(void);
+
+    /**
+     * Number of frames thrown away as malformed, oversized or because the 
+     * ring buffer was full. 
+     */
+    uint32_t getDropped(void);
+
+private: /* methods */
+    static uint8_t frameLength(uint8_t head);
+    void complete(void);
+    void drop(void);
+
+private: /* data */
+    uint8_t __frame[NEX_PARSER_FRAME_MAX + 3]; /* Frame being received, with terminator */
+    uint16_t __frame_len;   /* Bytes of __frame in use */
+    uint8_t __expect;       /* Total length of a fixed-length frame, 0 if terminated by 0xFF */
+    uint8_t __ff_count;     /* Consecutive trailing 0xFF bytes */
+    bool __discard;         /* Skipping to the next terminator after an error */
+
+    uint8_t __ring[NEX_PARSER_RING_SIZE]; /* Queued frames as [len][bytes...] */
+    uint16_t __head;        /* Next byte to read */
+    uint16_t __used;        /* Bytes of __ring in use */
+    uint16_t __frames;      /* Frames queued */
+    uint32_t __dropped;
+};
+
+/**
+ * @}
+ */
+
+#endif /* #ifndef __NEXPARSER_H__ */
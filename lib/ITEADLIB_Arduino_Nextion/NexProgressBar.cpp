@@ -29,6 +29,11 @@ bool NexProgressBar::getValue(uint32_t *number)
     return recvRetNumber(number);
 }
 
+uint16_t NexProgressBar::getValueAsync(uint32_t *number, NexCmdCb cb, void *ptr)
+{
+    return nexGetNumber(getObjName(), "val", number, cb, ptr);
+}
+
 bool NexProgressBar::setValue(uint32_t number)
 {
     char buf[10] = {0};
@@ -44,6 +44,17 @@ public: /* methods */
      * @retval false - failed. 
      */
     bool getValue(uint32_t *number);
+
+    /**
+     * Get the value of progress bar without waiting for the reply. 
+     * 
+     * @param number - an output parameter to save the value of progress bar. 
+     *  Must stay valid until cb is called. 
+     * @param cb - called from nexLoop when the reply arrives[default:NULL]. 
+     * @param ptr - parameter passed into cb[default:NULL]. 
+     * @return tag of the queued command, 0 for failure. 
+     */
+    uint16_t getValueAsync(uint32_t *number, NexCmdCb cb = NULL, void *ptr = NULL);
     
     /**
      * Set the value of progress bar.
@@ -28,6 +28,11 @@ bool NexSlider::getValue(uint32_t *number)
     return recvRetNumber(number);
 }
 
+uint16_t NexSlider::getValueAsync(uint32_t *number, NexCmdCb cb, void *ptr)
+{
+    return nexGetNumber(getObjName(), "val", number, cb, ptr);
+}
+
 bool NexSlider::setValue(uint32_t number)
 {
     char buf[10] = {0};
@@ -29,6 +29,11 @@ uint16_t NexText::getText(char *buffer, uint16_t len)
     return recvRetString(buffer,len);
 }
 
+uint16_t NexText::getTextAsync(char *buffer, uint16_t len, NexCmdCb cb, void *ptr)
+{
+    return nexGetString(getObjName(), "txt", buffer, len, cb, ptr);
+}
+
 bool NexText::setText(const char *buffer)
 {
     String cmd;
@@ -44,6 +44,18 @@ public: /* methods */
      */
     uint16_t getText(char *buffer, uint16_t len);
     
+    /**
+     * Get text attribute of component without waiting for the reply. 
+     *
+     * @param buffer - buffer storing text returned, terminated with '\0'. 
+     *  Must stay valid until cb is called. 
+     * @param len - length of buffer. 
+     * @param cb - called from nexLoop when the reply arrives[default:NULL]. 
+     * @param ptr - parameter passed into cb[default:NULL]. 
+     * @return tag of the queued command, 0 for failure. 
+     */
+    uint16_t getTextAsync(char *buffer, uint16_t len, NexCmdCb cb = NULL, void *ptr = NULL);
+    
     /**
      * Set text attribute of component.
      *
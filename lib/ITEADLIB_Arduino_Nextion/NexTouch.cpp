@@ -64,6 +64,19 @@ void NexTouch::pop(void)
     }
 }
 
+void NexTouch::dispatch(int32_t event)
+{
+    printObjInfo();
+    if (NEX_EVENT_PUSH == event)
+    {
+        push();
+    }
+    else if (NEX_EVENT_POP == event)
+    {
+        pop();
+    }
+}
+
 void NexTouch::iterate(NexTouch **list, uint8_t pid, uint8_t cid, int32_t event)
 {
     NexTouch *e = NULL;
@@ -78,18 +91,115 @@ void NexTouch::iterate(NexTouch **list, uint8_t pid, uint8_t cid, int32_t event)
     {
         if (e->getObjPid() == pid && e->getObjCid() == cid)
         {
-            e->printObjInfo();
-            if (NEX_EVENT_PUSH == event)
-            {
-                e->push();
-            }
-            else if (NEX_EVENT_POP == event)
-            {
-                e->pop();
-            }
-            
+            e->dispatch(event);
             break;
         }
     }
 }
 
+NexTouchTable::NexTouchTable(void)
+{
+    memset(__pages, 0, sizeof(__pages));
+    memset(__slots, 0, sizeof(__slots));
+}
+
+bool NexTouchTable::build(NexTouch **list)
+{
+    uint8_t last_cid[NEX_TOUCH_MAX_PAGES];
+    NexTouch *e = NULL;
+    uint16_t i = 0;
+    uint16_t offset = 0;
+    uint8_t pid;
+    uint8_t cid;
+
+    memset(__pages, 0, sizeof(__pages));
+    memset(__slots, 0, sizeof(__slots));
+    if (NULL == list)
+    {
+        return true;
+    }
+
+    /* Span of component ids per page */
+    for (i = 0; (e = list[i]) != NULL; i++)
+    {
+        pid = e->getObjPid();
+        cid = e->getObjCid();
+        if (pid >= NEX_TOUCH_MAX_PAGES)
+        {
+            memset(__pages, 0, sizeof(__pages));
+            return false;
+        }
+        if (0 == __pages[pid].count)
+        {
+            __pages[pid].first_cid = cid;
+            __pages[pid].count = 1;
+            last_cid[pid] = cid;
+        }
+        else if (cid < __pages[pid].first_cid)
+        {
+            __pages[pid].first_cid = cid;
+        }
+        else if (cid > last_cid[pid])
+        {
+            last_cid[pid] = cid;
+        }
+    }
+
+    for (pid = 0; pid < NEX_TOUCH_MAX_PAGES; pid++)
+    {
+        if (0 == __pages[pid].count)
+        {
+            continue;
+        }
+        /* A page spanning all 256 ids cannot fit NEX_TOUCH_TABLE_SIZE anyway */
+        if (last_cid[pid] - __pages[pid].first_cid + 1 > 255
+            || offset + last_cid[pid] - __pages[pid].first_cid + 1 > NEX_TOUCH_TABLE_SIZE)
+        {
+            memset(__pages, 0, sizeof(__pages));
+            return false;
+        }
+        __pages[pid].count = last_cid[pid] - __pages[pid].first_cid + 1;
+        __pages[pid].offset = offset;
+        offset += __pages[pid].count;
+    }
+
+    for (i = 0; (e = list[i]) != NULL; i++)
+    {
+        const Page *page = &__pages[e->getObjPid()];
+        NexTouch **slot = &__slots[page->offset + e->getObjCid() - page->first_cid];
+
+        if (NULL == *slot)
+        {
+            *slot = e;
+        }
+    }
+    return true;
+}
+
+NexTouch *NexTouchTable::find(uint8_t pid, uint8_t cid) const
+{
+    const Page *page;
+    uint8_t index;
+
+    if (pid >= NEX_TOUCH_MAX_PAGES)
+    {
+        return NULL;
+    }
+    page = &__pages[pid];
+    index = cid - page->first_cid;
+    if (cid < page->first_cid || index >= page->count)
+    {
+        return NULL;
+    }
+    return __slots[page->offset + index];
+}
+
+void NexTouchTable::dispatch(uint8_t pid, uint8_t cid, int32_t event) const
+{
+    NexTouch *e = find(pid, cid);
+
+    if (e)
+    {
+        e->dispatch(event);
+    }
+}
@@ -101,6 +101,9 @@ public: /* methods */
 private: /* methods */ 
     void push(void);
     void pop(void);
+    void dispatch(int32_t event);
+
+    friend class NexTouchTable;
     
 private: /* data */ 
     NexTouchEventCb __cb_push;
@@ -112,5 +115,59 @@ private: /* data */
 /**
  * @}
  */
+/**
+ * Touch components indexed by page id and component id, for dispatching a 
+ * touch event without scanning the listen list. 
+ *
+ * Built once from a listen list; each page takes a dense run of slots from its 
+ * lowest to its highest registered component id. 
+ */
+class NexTouchTable
+{
+public: /* methods */
+    NexTouchTable(void);
+
+    /**
+     * Index the components of a listen list. 
+     *
+     * @param list - NULL-terminated listen list. When a component is listed 
+     *  twice, the first entry wins, as with NexTouch::iterate. 
+     *
+     * @retval true - success. 
+     * @retval false - a page id is NEX_TOUCH_MAX_PAGES or more, or the components 
+     *  need more than NEX_TOUCH_TABLE_SIZE slots. The table is left empty. 
+     */
+    bool build(NexTouch **list);
+
+    /**
+     * Find the component touched. 
+     *
+     * @param pid - page id. 
+     * @param cid - component id. 
+     * @return the component, NULL if none is registered. 
+     */
+    NexTouch *find(uint8_t pid, uint8_t cid) const;
+
+    /**
+     * Call the push or pop callback of the component touched, if any. 
+     *
+     * @param pid - page id. 
+     * @param cid - component id. 
+     * @param event - NEX_EVENT_PUSH or NEX_EVENT_POP. 
+     * @return none. 
+     */
+    void dispatch(uint8_t pid, uint8_t cid, int32_t event) const;
+
+private: /* data */
+    struct Page
+    {
+        uint8_t first_cid;
+        uint8_t count;
+        uint16_t offset;
+    };
+
+    Page __pages[NEX_TOUCH_MAX_PAGES];
+    NexTouch *__slots[NEX_TOUCH_TABLE_SIZE];
+};
 
 #endif /* #ifndef __NEXTOUCH_H__ */
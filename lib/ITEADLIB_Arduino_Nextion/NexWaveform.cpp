@@ -33,4 +33,32 @@ bool NexWaveform::addValue(uint8_t ch, uint8_t number)
     sendCommand(buf);
     return true;
 }
- 
+
+uint16_t NexWaveform::addValues(uint8_t ch, const uint8_t *values, uint16_t count,
+                                NexCmdCb cb, void *ptr)
+{
+    char buf[24] = {0};
+
+    if (ch > 3 || !values || 0 == count || count > NEX_WAVEFORM_ADDT_MAX)
+    {
+        return 0;
+    }
+
+    sprintf(buf, "addt %u,%u,%u", getObjCid(), ch, count);
+
+    return nexSendTransparent(buf, values, count, cb, ptr);
+}
+
+uint16_t NexWaveform::clearChannel(uint8_t ch, NexCmdCb cb, void *ptr)
+{
+    char buf[16] = {0};
+
+    if (ch > 3 && ch != 255)
+    {
+        return 0;
+    }
+
+    sprintf(buf, "cle %u,%u", getObjCid(), ch);
+
+    return nexSendCommand(buf, cb, ptr);
+}
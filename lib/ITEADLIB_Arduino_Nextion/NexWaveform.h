@@ -23,6 +23,11 @@
  * @{ 
  */
 
+/**
+ * Most values one addt transfer can carry. 
+ */
+#define NEX_WAVEFORM_ADDT_MAX   (1024)
+
 /**
  * NexWaveform component.
  */
@@ -44,6 +49,32 @@ public: /* methods */
      * @retval false - failed. 
      */
     bool addValue(uint8_t ch, uint8_t number);
+
+    /**
+     * Add many values in one transparent transfer (addt) without waiting. 
+     *
+     * @param ch - channel of waveform(0-3). 
+     * @param values - the values of waveform, oldest first. Must stay valid 
+     *  until cb is called. 
+     * @param count - number of values (1-NEX_WAVEFORM_ADDT_MAX). 
+     * @param cb - called with the result[default:NULL]. 
+     * @param ptr - parameter passed into cb[default:NULL]. 
+     *
+     * @return tag identifying the transfer, 0 if the arguments are invalid. 
+     */
+    uint16_t addValues(uint8_t ch, const uint8_t *values, uint16_t count,
+                       NexCmdCb cb = NULL, void *ptr = NULL);
+
+    /**
+     * Clear a channel without waiting. 
+     *
+     * @param ch - channel of waveform(0-3), 255 for all channels. 
+     * @param cb - called with the result[default:NULL]. 
+     * @param ptr - parameter passed into cb[default:NULL]. 
+     *
+     * @return tag identifying the command, 0 if the channel is invalid. 
+     */
+    uint16_t clearChannel(uint8_t ch, NexCmdCb cb = NULL, void *ptr = NULL);
 };
 
 /**
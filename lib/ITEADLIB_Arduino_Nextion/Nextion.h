@@ -21,6 +21,8 @@
 #include "NexConfig.h"
 #include "NexTouch.h"
 #include "NexHardware.h"
+#include "NexParser.h"
+#include "NexEvent.h"
 
 #include "NexButton.h"
 #include "NexCrop.h"
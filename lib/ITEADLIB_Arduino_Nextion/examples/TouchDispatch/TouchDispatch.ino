@@ -0,0 +1,98 @@
+/**
+ * @example TouchDispatch.ino
+ *
+ * @par How to Use
+ * Compare the time NexTouch::iterate and NexTouchTable take to dispatch a
+ * touch event with 10, 50 and 200 registered components. No panel is needed;
+ * the results are printed to Serial.
+ *
+ * @copyright
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ */
+
+#include "Nextion.h"
+
+#define MAX_COMPONENTS      (200)
+#define COMPONENTS_PER_PAGE (25)
+#define ROUNDS              (1000)
+
+/* Page and component id of the i-th registered component */
+#define PID(i) ((uint8_t)((i) / COMPONENTS_PER_PAGE))
+#define CID(i) ((uint8_t)(1 + (i) % COMPONENTS_PER_PAGE))
+
+static NexTouch *components[MAX_COMPONENTS + 1];
+static NexTouchTable table;
+static volatile uint32_t touches = 0;
+
+static void touched(void *ptr)
+{
+    touches++;
+}
+
+/* Average microseconds per dispatch, touching every registered component in turn */
+static float timeIterate(uint16_t count)
+{
+    uint32_t start = micros();
+
+    for (uint16_t round = 0; round < ROUNDS; round++)
+    {
+        uint16_t i = round % count;
+        NexTouch::iterate(components, PID(i), CID(i), NEX_EVENT_PUSH);
+    }
+    return (float)(micros() - start) / ROUNDS;
+}
+
+static float timeTable(uint16_t count)
+{
+    uint32_t start = micros();
+
+    for (uint16_t round = 0; round < ROUNDS; round++)
+    {
+        uint16_t i = round % count;
+        table.dispatch(PID(i), CID(i), NEX_EVENT_PUSH);
+    }
+    return (float)(micros() - start) / ROUNDS;
+}
+
+void setup(void)
+{
+    const uint16_t sizes[] = {10, 50, 200};
+
+    Serial.begin(115200);
+
+    for (uint16_t i = 0; i < MAX_COMPONENTS; i++)
+    {
+        components[i] = new NexTouch(PID(i), CID(i), "b");
+        components[i]->attachPush(touched);
+    }
+
+    for (uint8_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        uint16_t count = sizes[s];
+        NexTouch *next = components[count];
+
+        components[count] = NULL; /* Terminate the listen list */
+        if (!table.build(components))
+        {
+            Serial.println("table does not fit NEX_TOUCH_TABLE_SIZE");
+            components[count] = next;
+            continue;
+        }
+
+        Serial.print(count);
+        Serial.print(" components: iterate ");
+        Serial.print(timeIterate(count), 2);
+        Serial.print(" us, table ");
+        Serial.print(timeTable(count), 2);
+        Serial.println(" us per event");
+
+        components[count] = next;
+    }
+}
+
+void loop(void)
+{
+}
@@ -1,7 +1,10 @@
 #pragma once
+#include "Clock.h"
 #include "Config.h"
 #include "DisplayManager.h"
 #include "EnergyEstimator.h"
+#include "EventBus.h"
+#include "Scheduler.h"
 #include "SensorHelper.h"
 #include "WeatherHelper.h"
 #include <Arduino.h>
@@ -24,7 +27,7 @@ struct AlertInfo {
     AlertType type;
     String message;
     bool active;
-    uint32_t firstTriggered;
+    uint64_t firstTriggered;
 };
 
 class AlertManager {
@@ -32,7 +35,7 @@ public:
     explicit AlertManager(DisplayManager &disp, SensorHelper &sensors, EnergyEstimator &energy, WeatherHelper &weather)
         : _disp(disp), _sensors(sensors), _energy(energy), _weather(weather) {}
 
-    void begin() {
+    void begin(Scheduler &scheduler, EventBus &events) {
         if (Config::BUZZER_ENABLED) {
             pinMode(Config::BUZZER_PIN, OUTPUT);
             digitalWrite(Config::BUZZER_PIN, LOW);
@@ -40,23 +43,20 @@ public:
 
         // Initialize alerts
         initializeAlerts();
-    }
 
-    void poll() {
-        // Check for alerts at regular intervals
-        if (millis() - _lastAlertCheck >= Config::ALERT_CHECK_INTERVAL_MS) {
-            checkAlerts();
-            updateDisplay();
-            _lastAlertCheck = millis();
+        // Checked as soon as any input changes; the timer only catches up with missed changes
+        _scheduler = &scheduler;
+        _checkTask = scheduler.add("alerts", onCheckTask, this);
+        events.subscribe(Event::INDOOR_SAMPLE, onInputChanged, this);
+        events.subscribe(Event::GAS_SAMPLE, onInputChanged, this);
+        events.subscribe(Event::OUTDOOR_SAMPLE, onInputChanged, this);
+        events.subscribe(Event::ENERGY_UPDATE, onInputChanged, this);
+        if (Config::BUZZER_ENABLED) {
+            _buzzerTask = scheduler.add("buzzer", onBuzzerTask, this, Config::ALERT_CHECK_INTERVAL_MS);
         }
 
-        // Handle buzzer only when needed with precise timing (every 10ms for accuracy)
-        if (Config::BUZZER_ENABLED &&
-            (hasActiveAlerts() || _buzzerState != BuzzerState::IDLE) &&
-            (millis() - _lastBuzzerCheck >= 10)) {
-            handleBuzzer();
-            _lastBuzzerCheck = millis();
-        }
+        // Opening main hides the indicators and drops cached values; show the current ones again
+        _disp.onPageOpen(Config::DISPLAY_PAGE_MAIN, onMainOpen, this);
     }
 
     // Get current alerts as a formatted string for display
@@ -77,6 +77,10 @@ public:
         return hasAlerts ? ("Alerts: " + result) : "No alerts";
     }
 
+    // Checks run, and timer runs that found no new input to check
+    uint32_t getChecks() const { return _checks; }
+    uint32_t getSkippedChecks() const { return _skippedChecks; }
+
     // Check if any alerts are currently active
     bool hasActiveAlerts() const {
         for (const auto &alert : _alerts) {
@@ -120,6 +124,42 @@ public:
     }
 
 private:
+    static void onInputChanged(Event, void *ptr) {
+        AlertManager *self = static_cast<AlertManager *>(ptr);
+        self->_inputsChanged = true;
+        self->_scheduler->runSoon(self->_checkTask);
+    }
+
+    static void onMainOpen(void *ptr) {
+        static_cast<AlertManager *>(ptr)->updateDisplay();
+    }
+
+    static uint32_t onCheckTask(void *ptr) {
+        AlertManager *self = static_cast<AlertManager *>(ptr);
+        if (!self->_inputsChanged) {
+            self->_skippedChecks++; // Nothing new since the last check
+            return Config::ALERT_CHECK_INTERVAL_MS;
+        }
+        self->_inputsChanged = false;
+        self->_checks++;
+        self->checkAlerts();
+        self->updateDisplay();
+        if (self->hasActiveAlerts()) {
+            self->_scheduler->runSoon(self->_buzzerTask); // Start beeping without waiting for the idle check
+        }
+        return Config::ALERT_CHECK_INTERVAL_MS;
+    }
+
+    // Every 10 ms for accurate beeps while needed, otherwise only as a fallback to the alert check
+    static uint32_t onBuzzerTask(void *ptr) {
+        AlertManager *self = static_cast<AlertManager *>(ptr);
+        if (!self->hasActiveAlerts() && self->_buzzerState == BuzzerState::IDLE) {
+            return Config::ALERT_CHECK_INTERVAL_MS;
+        }
+        self->handleBuzzer();
+        return 10;
+    }
+
     // Helper method to check if a specific alert type is active
     bool isAlertActive(AlertType type) const {
         for (const auto &alert : _alerts) {
@@ -143,7 +183,7 @@ private:
     }
 
     void checkAlerts() {
-        uint32_t currentTime = millis();
+        uint64_t currentTime = Clock::nowMs();
 
         // Check temperature alerts
         if (_sensors.isDataValid() && !isnan(_weather.getCurrentTemp())) {
@@ -195,7 +235,7 @@ private:
         checkAndUpdateAlert(AlertType::DAILY_COST_HIGH, dailyCost > Config::DAILY_COST_HIGH_THRESHOLD, currentTime);
     }
 
-    void checkAndUpdateAlert(AlertType type, bool condition, uint32_t currentTime) {
+    void checkAndUpdateAlert(AlertType type, bool condition, uint64_t currentTime) {
         for (auto &alert : _alerts) {
             if (alert.type == type) {
                 if (condition && !alert.active) {
@@ -235,7 +275,7 @@ private:
             return;
         }
 
-        uint32_t currentTime = millis();
+        uint64_t currentTime = Clock::nowMs();
 
         switch (_buzzerState) {
         case BuzzerState::IDLE:
@@ -293,12 +333,16 @@ private:
     EnergyEstimator &_energy;
     WeatherHelper &_weather;
 
-    uint32_t _lastAlertCheck = 0;
-    uint32_t _lastBuzzerCheck = 0; // Add timing control for buzzer
+    Scheduler *_scheduler = nullptr;
+    int8_t _checkTask = -1;
+    int8_t _buzzerTask = -1;
+    bool _inputsChanged = true;
+    uint32_t _checks = 0;
+    uint32_t _skippedChecks = 0;
     AlertInfo _alerts[10];         // Array to store all alert types (increased from 9 to 10)
 
     // Buzzer state management
     BuzzerState _buzzerState = BuzzerState::IDLE;
-    uint32_t _buzzerStartTime = 0;
+    uint64_t _buzzerStartTime = 0;
     uint8_t _beepCount = 0;
 };
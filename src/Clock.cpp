@@ -0,0 +1,13 @@
+#include "Clock.h"
+
+namespace Clock {
+    namespace detail {
+        uint32_t msWraps = 0;
+        uint32_t msLast = 0;
+        int64_t epochOffsetMs = 0;
+    }
+
+    void setEpoch(time_t epochSec) {
+        detail::epochOffsetMs = (int64_t)epochSec * 1000 - (int64_t)nowMs();
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+
+// Uptime that does not wrap. millis() starts over after 49.7 days and micros() after 71.6
+// minutes; these 64-bit counts outlast the hardware. Keep long-lived timestamps as Clock::nowMs()
+// and compare them with the helpers below. The millisecond count extends millis() by counting its
+// wraps on each read, so it must be read at least once per wrap (loop() does so every pass) and
+// only from loop() and tasks, never from an interrupt.
+namespace Clock {
+    namespace detail {
+        extern uint32_t msWraps;      // Times millis() wrapped so far
+        extern uint32_t msLast;       // millis() at the previous read
+        extern int64_t epochOffsetMs; // Epoch minus uptime, in ms; 0 until setEpoch()
+    }
+
+    inline uint64_t nowMs() {
+        uint32_t ms = millis();
+        if (ms < detail::msLast) detail::msWraps++;
+        detail::msLast = ms;
+        return (uint64_t)detail::msWraps << 32 | ms;
+    }
+
+    inline uint64_t nowUs() { return micros64(); } // Kept by the core, safe anywhere
+
+    // A timestamp restored as "now minus an age" may lie before boot: the subtraction wraps, and
+    // elapsedMs() wraps it back, so ages stay exact
+    inline uint64_t elapsedMs(uint64_t sinceMs) { return nowMs() - sinceMs; }
+    inline bool hasElapsed(uint64_t sinceMs, uint64_t intervalMs) { return elapsedMs(sinceMs) >= intervalMs; }
+    inline uint64_t deadlineIn(uint64_t delayMs) { return nowMs() + delayMs; }
+    inline bool reached(uint64_t deadlineMs) { return nowMs() >= deadlineMs; }
+
+    // Tie uptime to wall-clock time, once NTP has answered
+    void setEpoch(time_t epochSec);
+    inline bool hasEpoch() { return detail::epochOffsetMs != 0; }
+    inline uint64_t toEpochMs(uint64_t uptimeMs) { return hasEpoch() ? uptimeMs + detail::epochOffsetMs : 0; }
+    inline uint64_t epochMs() { return toEpochMs(nowMs()); }
+}
@@ -11,7 +11,8 @@ namespace Config {
     constexpr char PASSWORD[] = "Shikanokonoko";    // Wi-Fi Password
     constexpr int WIFI_TIMEOUT_MS = 15'000;         // Wi-Fi connection timeout
     constexpr int WIFI_RETRY_DELAY_MS = 5'000;      // Wi-Fi reconnection delay
-    constexpr uint32_t WIFI_CONNECT_DELAY_MS = 250; // Delay between Wi-Fi connection attempts
+    constexpr uint32_t WIFI_CONNECT_DELAY_MS = 250; // How often a connection attempt is checked on
+    constexpr uint32_t NETWORK_WAIT_MS = 1'000;     // How often network tasks look again while Wi-Fi is down
 
     /* Network Timeouts ------------------------------------------- */
     constexpr uint32_t HTTP_TIMEOUT_MS = 15'000; // HTTP request timeout
@@ -21,7 +22,7 @@ namespace Config {
     constexpr long GMT_OFFSET_SEC = 8 * 3600;        // UTC+8
     constexpr char NTP_SERVER[] = "pool.ntp.org";    // NTP server for time synchronization
     constexpr uint32_t NTP_MIN_EPOCH_TIME = 100'000; // Minimum time to wait for NTP sync
-    constexpr uint32_t NTP_SYNC_DELAY_MS = 100;      // Delay between NTP sync checks
+    constexpr uint32_t NTP_SYNC_DELAY_MS = 500;      // Delay between NTP sync checks
 
     /* Weather / Location ---------------------------------------- */
     constexpr double LATITUDE = 1.330591328881519;
@@ -47,11 +48,14 @@ namespace Config {
     // =======================================================================
 
     /* Sensors --------------------------------------------------- */
-    constexpr uint8_t DHT22_PIN = 5;              // GPIO 5 (D1 on NodeMCU)
-    constexpr uint8_t MQ9_ANALOG_PIN = A0;        // Analog pin for MQ-9 CO sensor
-    constexpr uint8_t MQ131_DIGITAL_PIN = 4;      // GPIO 4 (D2 on NodeMCU) for MQ-131 ozone sensor
-    constexpr uint32_t SENSOR_REFRESH_MS = 5'000; // Read sensors every 5 seconds
-    constexpr uint8_t MAX_SENSOR_FAILURES = 5;    // Max consecutive failed readings before reinit
+    constexpr uint8_t DHT22_PIN = 5;                  // GPIO 5 (D1 on NodeMCU)
+    constexpr uint8_t MQ9_ANALOG_PIN = A0;            // Analog pin for MQ-9 CO sensor
+    constexpr uint8_t MQ131_DIGITAL_PIN = 4;          // GPIO 4 (D2 on NodeMCU) for MQ-131 ozone sensor
+    constexpr uint32_t SENSOR_REFRESH_MS = 5'000;     // Read sensors every 5 seconds
+    constexpr uint32_t DHT22_MIN_INTERVAL_MS = 2'000; // DHT22 sampling period, retry delay until its first reading
+    constexpr uint32_t DHT22_START_SIGNAL_MS = 2;     // Start signal held low (the sensor needs at least 1 ms)
+    constexpr uint32_t DHT22_FRAME_TIMEOUT_MS = 10;   // Give up on an answer (normally 5 ms) after this long
+    constexpr uint8_t MAX_SENSOR_FAILURES = 5;        // Max consecutive failed readings before reinit
 
     /* Buzzer / Alerts ------------------------------------------- */
     constexpr bool BUZZER_ENABLED = false;              // Enable/disable buzzer functionality
@@ -82,9 +86,76 @@ namespace Config {
 
     /* Misc / Timing ---------------------------------------------- */
     constexpr uint32_t CLOCK_REFRESH_MS = 1'000;        // Update once per second
-    constexpr uint32_t COMPONENT_INIT_DELAY_MS = 3'000; // Delay after component initialization
+    constexpr bool CLOCK_USE_PANEL_RTC = true;          // Let the Nextion RTC run the clock (HMI timer renders rtc0..rtc5)
+    constexpr uint32_t CLOCK_RTC_RESYNC_MS = 21'600'000; // Rewrite the panel RTC from NTP every 6 hours to cancel drift
+    constexpr uint32_t CLOCK_RTC_RETRY_MS = 60'000;     // Wait before retrying an RTC write the panel did not answer
+    constexpr uint32_t STARTUP_SPLASH_MS = 1'000;       // Start page shown this long after boot (components already run)
     constexpr uint32_t MILLISECONDS_PER_DAY = 86400000; // 24 hours in milliseconds
 
+    /* Scheduler -------------------------------------------------- */
+    constexpr uint8_t SCHEDULER_TASK_SLOTS = 12;           // Periodic tasks the helpers can register
+    constexpr uint32_t SCHEDULER_IDLE_SLICE_MS = 1;        // Nap while no task is due but the panel owes a reply (or POWER_MODE is ACTIVE)
+    constexpr uint8_t PERF_PROBE_SLOTS = 20;               // Latency histograms: one per task plus the loop() probes
+    constexpr uint8_t EVENT_SUBSCRIBER_SLOTS = 4;          // Subscribers per event type on the event bus
+    constexpr uint16_t TRACE_SPANS = 128;                  // Span records kept for the `trace` command, 16 bytes each (0 to compile tracing out)
+
+    /* Power ------------------------------------------------------ */
+    enum class PowerMode : uint8_t {
+        ACTIVE,      // Radio and CPU always on
+        MODEM_SLEEP, // Radio off between beacons, CPU on
+        LIGHT_SLEEP  // Radio and CPU suspended while no task is due (needs a connected station)
+    };
+    constexpr PowerMode POWER_MODE = PowerMode::LIGHT_SLEEP;
+    constexpr uint8_t POWER_LISTEN_INTERVAL = 3;           // DTIM beacons slept through in light sleep (1-10)
+    constexpr uint32_t POWER_MAX_NAP_MS = 100;             // Longest idle stretch per loop pass, bounds touch latency
+    constexpr uint32_t POWER_WINDOW_MS = 60'000;           // Loop busy time is reported per window
+
+    /* Warm start ------------------------------------------------- */
+    constexpr uint32_t WARM_START_SNAPSHOT_MS = 10'000;    // How often state is saved to RTC user memory
+    constexpr uint32_t WARM_START_RTC_OFFSET = 32;         // In 4-byte blocks; the first 128 bytes belong to OTA updates
+    constexpr uint32_t WARM_START_MAGIC = 0x41524D01;      // Snapshot layout version, change with WarmState
+
+    /* Console ---------------------------------------------------- */
+    constexpr uint8_t CONSOLE_LINE_SIZE = 96;              // Longest command line, longer ones are cut
+    constexpr uint8_t CONSOLE_EXTRA_COMMANDS = 8;          // Commands components can register next to the built-in table
+    // Only used when the panel has UART0 to itself (NEX_SERIAL_SWAP build flag)
+    constexpr uint32_t CONSOLE_BAUD = 115'200;             // Serial1 (GPIO2, TX only) console output
+    constexpr uint16_t CONSOLE_TELNET_PORT = 23;           // Telnet console for commands and output (0 for Serial1 only)
+
+    /* Display ---------------------------------------------------- */
+    constexpr uint8_t DISPLAY_SHADOW_SLOTS = 64;           // Cached element values used to skip redundant Nextion writes
+    constexpr uint32_t DISPLAY_BAUD = 115'200;             // Rate negotiated after connecting at 9600 (0 to stay at 9600)
+    constexpr uint8_t DISPLAY_BAUD_FALLBACK_TIMEOUTS = 3;  // Unanswered commands in a row before falling back to 9600
+    constexpr size_t DISPLAY_CMD_BUFFER_SIZE = 128;        // Longest Nextion command, escapes and terminator included
+    constexpr size_t DISPLAY_TEXT_BUFFER_SIZE = 64;        // Longest text composed for a single element
+    constexpr uint8_t DISPLAY_PAGE_START = 0;              // Page ids as numbered in the HMI file
+    constexpr uint8_t DISPLAY_PAGE_MAIN = 1;
+    constexpr uint8_t DISPLAY_PAGE_DETAILS = 2;
+    constexpr uint8_t DISPLAY_PAGE_HEATLOAD = 3;
+    constexpr uint8_t DISPLAY_PAGE_TRENDS = 4;
+    constexpr uint32_t DISPLAY_PAGE_POLL_MS = 1'000;       // How often the panel is asked which page is open (sendme)
+    constexpr uint8_t DISPLAY_QUEUE_SLOTS = 32;            // Element writes waiting for their turn or for their page to open
+    constexpr uint32_t DISPLAY_TICK_BYTE_BUDGET = 128;     // Most bytes sent to the panel per loop tick
+    constexpr uint16_t DISPLAY_SLEEP_TIMEOUT_S = 300;      // Idle seconds before the panel sleeps (thsp, 3-65535; 0 keeps the HMI's setting)
+    constexpr bool DISPLAY_WAKE_ON_TOUCH = true;           // Touching the sleeping panel wakes it (thup)
+    constexpr uint32_t DISPLAY_LINK_WINDOW_MS = 60'000;    // Window the link traffic is reported per
+
+    /* Trend Graphs ----------------------------------------------- */
+    constexpr uint8_t TREND_CLIMATE_WAVEFORM_ID = 1;       // Trends page waveform: ch0/1 in/out temp, ch2/3 in/out RH
+    constexpr uint8_t TREND_POWER_WAVEFORM_ID = 2;         // Trends page waveform: ch0 estimated power
+    constexpr uint16_t TREND_WAVEFORM_WIDTH = 240;         // Waveform width in pixels, one point per pixel
+    constexpr uint8_t TREND_SAMPLES_PER_POINT = 2;         // History samples downsampled (LTTB) into each point
+    constexpr uint32_t TREND_SAMPLE_INTERVAL_MS = 60'000;  // 240 points x 2 samples x 1 min = 8 h on screen
+    constexpr float TREND_TEMP_MIN = 15.0;                 // °C at the bottom of the graph
+    constexpr float TREND_TEMP_MAX = 40.0;                 // °C at the top of the graph
+    constexpr float TREND_HUMIDITY_MIN = 0.0;              // % at the bottom of the graph
+    constexpr float TREND_HUMIDITY_MAX = 100.0;            // % at the top of the graph
+
+    /* Panel Update ----------------------------------------------- */
+    constexpr char PANEL_UPDATE_URL[] = "http://192.168.1.10:8000/airia.tft"; // HMI image fetched by "panelUpdate" (plain HTTP)
+    constexpr uint32_t PANEL_UPDATE_BAUD = 115'200;        // Rate the image is sent to the panel at
+    constexpr uint32_t PANEL_UPDATE_REBOOT_MS = 5'000;     // Time the panel takes to restart with the new HMI
+
     // =======================================================================
     // ENERGY ESTIMATION MODEL
     // =======================================================================
@@ -0,0 +1,196 @@
+#pragma once
+#include "Config.h"
+#include <ESP8266WiFi.h>
+#include <Nextion.h>
+
+// One console command: its handler gets the output and whatever followed the name on the line
+struct ConsoleCommand {
+    typedef void (*Handler)(Print &out, const char *args, void *ptr);
+
+    const char *name;
+    const char *help; // One line for the help listing
+    Handler handler;
+    void *ptr;
+};
+
+// Where console commands come from and where their output goes, chosen by the build layout:
+// - NEX_SERIAL_SWAP defined: the panel has UART0 to itself on GPIO15/GPIO13. Output goes to the
+//   TX-only Serial1 (GPIO2) and to a telnet client; commands come from the telnet client.
+// - Otherwise: the console shares Serial with the panel, as on the original wiring.
+// Input is collected a byte at a time and never waited for. A complete line is looked up by
+// binary search, first in the built-in table (sorted at compile time), then among the commands
+// components registered with addCommand().
+class Console : public Stream {
+public:
+    void begin() {
+#ifdef NEX_SERIAL_SWAP
+        Serial1.begin(Config::CONSOLE_BAUD);
+        if (Config::CONSOLE_TELNET_PORT) {
+            _server.begin();
+            _server.setNoDelay(true);
+        }
+#else
+        Serial.begin(NEX_DEFAULT_BAUD); // Reopened by the display at its own rate
+#endif
+    }
+
+    // The built-in commands; must be sorted by name (check with isSorted() in a static_assert)
+    template <size_t N>
+    void setCommands(const ConsoleCommand (&table)[N]) {
+        _builtins = table;
+        _builtinCount = N;
+    }
+
+    // Add a command from a component. Returns false if the name is taken or all
+    // CONSOLE_EXTRA_COMMANDS slots are.
+    bool addCommand(const char *name, const char *help, ConsoleCommand::Handler handler, void *ptr) {
+        if (_extraCount >= Config::CONSOLE_EXTRA_COMMANDS || find(name, strlen(name))) return false;
+
+        uint8_t pos = _extraCount++;
+        while (pos > 0 && compare(name, _extras[pos - 1].name) < 0) {
+            _extras[pos] = _extras[pos - 1]; // Keep them sorted for the binary search
+            pos--;
+        }
+        _extras[pos] = {name, help, handler, ptr};
+        return true;
+    }
+
+    // Take over from a previous telnet client when a new one connects, then run the command on
+    // any complete line that has arrived
+    void poll() {
+#ifdef NEX_SERIAL_SWAP
+        if (Config::CONSOLE_TELNET_PORT && _server.hasClient()) {
+            _client.stop();
+            _client = _server.accept();
+            _lineLength = 0;
+        }
+#endif
+        const char *line = readLine();
+        if (line) execute(line);
+    }
+
+    // "  name - help" for every command
+    void printCommands(Print &out) const {
+        for (uint8_t i = 0; i < _builtinCount; i++) printCommand(out, _builtins[i]);
+        for (uint8_t i = 0; i < _extraCount; i++) printCommand(out, _extras[i]);
+    }
+
+    static constexpr bool isSorted(const ConsoleCommand *table, size_t count) {
+        for (size_t i = 1; i < count; i++) {
+            if (compare(table[i - 1].name, table[i].name) >= 0) return false;
+        }
+        return true;
+    }
+
+    int available() override { return input() ? input()->available() : 0; }
+    int read() override { return input() ? input()->read() : -1; }
+    int peek() override { return input() ? input()->peek() : -1; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override {
+#ifdef NEX_SERIAL_SWAP
+        if (_client.connected()) _client.write(buffer, size);
+        return Serial1.write(buffer, size);
+#else
+        return Serial.write(buffer, size);
+#endif
+    }
+
+private:
+    static constexpr uint8_t NAME_WIDTH = 17; // Help text column
+
+    // strcmp() usable in constant expressions
+    static constexpr int compare(const char *a, const char *b) {
+        while (*a && *a == *b) {
+            a++;
+            b++;
+        }
+        return (uint8_t)*a - (uint8_t)*b;
+    }
+
+    // Same order, for a name that is not terminated after its length
+    static int compare(const char *name, size_t length, const char *other) {
+        int order = strncmp(name, other, length);
+        return order ? order : -(uint8_t)other[length];
+    }
+
+    static const ConsoleCommand *search(const ConsoleCommand *table, uint8_t count, const char *name, size_t length) {
+        uint8_t low = 0, high = count;
+        while (low < high) {
+            uint8_t mid = (low + high) / 2;
+            int order = compare(name, length, table[mid].name);
+            if (order == 0) return &table[mid];
+            if (order < 0) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        return nullptr;
+    }
+
+    const ConsoleCommand *find(const char *name, size_t length) const {
+        const ConsoleCommand *command = search(_builtins, _builtinCount, name, length);
+        return command ? command : search(_extras, _extraCount, name, length);
+    }
+
+    // A complete line without its line ending, nullptr while it is still arriving
+    const char *readLine() {
+        while (available() > 0) {
+            char c = read();
+            if (c == '\r' || c == '\n') {
+                if (_lineLength == 0) continue; // Second half of CR LF, or an empty line
+                _line[_lineLength] = '\0';
+                _lineLength = 0;
+                return _line;
+            }
+            if (_lineLength < sizeof(_line) - 1) _line[_lineLength++] = c;
+        }
+        return nullptr;
+    }
+
+    void execute(const char *line) {
+        while (*line == ' ') line++;
+        size_t length = strcspn(line, " ");
+        const char *args = line + length;
+        while (*args == ' ') args++;
+
+        if (length == 0) return;
+        const ConsoleCommand *command = find(line, length);
+        if (!command) {
+            print("Unknown command: ");
+            println(line);
+            println("Type 'help' for available commands");
+            return;
+        }
+        command->handler(*this, args, command->ptr);
+    }
+
+    static void printCommand(Print &out, const ConsoleCommand &command) {
+        out.print("  ");
+        out.print(command.name);
+        for (size_t i = strlen(command.name); i < NAME_WIDTH; i++) out.print(' ');
+        out.print(" - ");
+        out.println(command.help);
+    }
+
+    Stream *input() {
+#ifdef NEX_SERIAL_SWAP
+        return _client.connected() ? &_client : nullptr; // Serial1 cannot receive
+#else
+        return &Serial;
+#endif
+    }
+
+    const ConsoleCommand *_builtins = nullptr;
+    uint8_t _builtinCount = 0;
+    ConsoleCommand _extras[Config::CONSOLE_EXTRA_COMMANDS] = {};
+    uint8_t _extraCount = 0;
+    char _line[Config::CONSOLE_LINE_SIZE];
+    uint8_t _lineLength = 0;
+
+#ifdef NEX_SERIAL_SWAP
+    WiFiServer _server{Config::CONSOLE_TELNET_PORT};
+    WiFiClient _client;
+#endif
+};
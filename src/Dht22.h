@@ -0,0 +1,132 @@
+#pragma once
+#include "Clock.h"
+#include "Config.h"
+
+// DHT22 reader that never blocks. A library read bit-bangs the 40-bit frame with interrupts off
+// for about 5 ms, long enough to drop UART bytes from the panel and to starve Wi-Fi. Here the
+// start signal is held across scheduler runs, a GPIO interrupt timestamps every edge of the
+// answer with the cycle counter, and the frame is decoded on a later poll() once the line is quiet.
+//
+// The answer after the start signal: low 80 us, high 80 us, then per bit low 50 us and high
+// 26-28 us (0) or 70 us (1), then low 50 us before the line is released. That is 84 edges; one
+// more may lead if the interrupt also saw the line being released.
+class Dht22 {
+public:
+    explicit Dht22(uint8_t pin) : _pin(pin) {}
+
+    // Also used to recover a sensor that stopped answering
+    void begin() {
+        detachInterrupt(digitalPinToInterrupt(_pin));
+        pinMode(_pin, INPUT_PULLUP);
+        _phase = Phase::IDLE;
+    }
+
+    // Advance the read. Returns the milliseconds until it needs poll() again, or 0 once a reading
+    // (or a failure) is ready. Polled again after that, it starts the next read.
+    uint32_t poll() {
+        switch (_phase) {
+        case Phase::IDLE:
+            pinMode(_pin, OUTPUT);
+            digitalWrite(_pin, LOW); // Start signal, at least 1 ms
+            _phase = Phase::START_SIGNAL;
+            return Config::DHT22_START_SIGNAL_MS;
+
+        case Phase::START_SIGNAL:
+            _edgeCount = 0;
+            pinMode(_pin, INPUT_PULLUP);
+            attachInterruptArg(digitalPinToInterrupt(_pin), onEdge, this, CHANGE);
+            _listenStart = Clock::nowMs();
+            _phase = Phase::RECEIVING;
+            return 1;
+
+        case Phase::RECEIVING:
+        default:
+            if (!isFrameComplete() && !Clock::hasElapsed(_listenStart, Config::DHT22_FRAME_TIMEOUT_MS)) {
+                return 1;
+            }
+            detachInterrupt(digitalPinToInterrupt(_pin));
+            decode();
+            _phase = Phase::IDLE;
+            return 0;
+        }
+    }
+
+    // From the last frame, NAN if it failed
+    float getTemperature() const { return _temperature; }
+    float getHumidity() const { return _humidity; }
+
+    uint32_t getReads() const { return _reads; }
+    uint32_t getDecodeFailures() const { return _decodeFailures; } // No answer, or edges missing or extra
+    uint32_t getChecksumErrors() const { return _checksumErrors; }
+
+private:
+    static constexpr uint8_t FRAME_EDGES = 84;
+    static constexpr uint8_t MAX_EDGES = FRAME_EDGES + 1;
+    static constexpr uint32_t QUIET_US = 100;  // Longer than any level within the frame
+    static constexpr uint32_t ONE_BIT_US = 48; // High levels longer than this are 1 bits
+
+    enum class Phase : uint8_t {
+        IDLE,         // Line released, nothing in progress
+        START_SIGNAL, // Holding the line low
+        RECEIVING     // Line released, the interrupt collects edges
+    };
+
+    static void IRAM_ATTR onEdge(void *ptr) {
+        Dht22 *self = static_cast<Dht22 *>(ptr);
+        uint8_t count = self->_edgeCount;
+        if (count < MAX_EDGES) {
+            self->_edges[count] = ESP.getCycleCount();
+            self->_edgeCount = count + 1;
+        }
+    }
+
+    // All edges in, and the release after the last bit is over
+    bool isFrameComplete() const {
+        uint8_t count = _edgeCount;
+        if (count < FRAME_EDGES) return false;
+        return count == MAX_EDGES || ESP.getCycleCount() - _edges[count - 1] > QUIET_US * ESP.getCpuFreqMHz();
+    }
+
+    void decode() {
+        _reads++;
+        _temperature = NAN;
+        _humidity = NAN;
+
+        uint8_t count = _edgeCount;
+        if (count != FRAME_EDGES && count != MAX_EDGES) {
+            _decodeFailures++;
+            return;
+        }
+
+        // Bit i is high from edge 3 + 2i to edge 4 + 2i of the answer
+        const volatile uint32_t *edges = _edges + (count - FRAME_EDGES);
+        uint32_t threshold = ONE_BIT_US * ESP.getCpuFreqMHz();
+        uint8_t data[5] = {};
+        for (uint8_t i = 0; i < 40; i++) {
+            uint32_t high = edges[4 + 2 * i] - edges[3 + 2 * i];
+            data[i / 8] = data[i / 8] << 1 | (high > threshold);
+        }
+
+        if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+            _checksumErrors++;
+            return;
+        }
+
+        _humidity = (data[0] << 8 | data[1]) / 10.0;
+        float temperature = ((data[2] & 0x7F) << 8 | data[3]) / 10.0;
+        _temperature = data[2] & 0x80 ? -temperature : temperature;
+    }
+
+    const uint8_t _pin;
+    Phase _phase = Phase::IDLE;
+    uint64_t _listenStart = 0;
+
+    volatile uint32_t _edges[MAX_EDGES] = {}; // Cycle counter at each edge
+    volatile uint8_t _edgeCount = 0;
+
+    float _temperature = NAN;
+    float _humidity = NAN;
+    uint32_t _reads = 0;
+    uint32_t _decodeFailures = 0;
+    uint32_t _checksumErrors = 0;
+};
@@ -1,180 +1,911 @@
 #pragma once
+#include "Clock.h"
+#include "Config.h"
+#include "TextBuffer.h"
+#include "Tracer.h"
 #include <ESP8266WiFi.h>
 #include <Nextion.h>
+#include <time.h>
 
 class DisplayManager {
 public:
+    typedef void (*PageRenderer)(void *ptr);
+
+    // Whether the panel's own RTC keeps the clock
+    enum class PanelClock : uint8_t {
+        UNKNOWN, // Never set, or the last attempt went unanswered
+        SETTING, // Registers written, waiting for the panel to accept them
+        RUNNING, // The HMI renders the clock from rtc0..rtc5
+        MISSING  // Model without an RTC (Basic series), the MCU sends the clock
+    };
+
+    // Waveforms on the trends page
+    enum class Waveform : uint8_t {
+        CLIMATE,
+        POWER
+    };
+
+    // UART traffic over one DISPLAY_LINK_WINDOW_MS window
+    struct LinkUsage {
+        uint32_t txBytes;
+        uint32_t rxBytes;
+        uint32_t txCommands;
+        uint32_t txWireMs; // Time the line was busy sending
+        uint32_t rxWireMs;
+    };
+
+    // Order in which queued writes reach the panel
+    enum class Priority : uint8_t {
+        ALERT,     // Warning indicators
+        SENSOR,    // Readings on the main page, startup progress
+        BACKGROUND // Clock, details and heat load pages
+    };
+
     void begin() {
         nexInit();
-        sendCmd("page start");
+        nexAttachEvent(onNexEvent, this);
+        upgradeBaud();
+        setSleepTimeouts();
+        showPage("start");
         sendCmd("start.arduinoConn.txt=\"Arduino connected!\"");
+        showBaudRate();
         hide("wifiConn");
         hide("timeSync");
         hide("dhtSensor");
     }
 
+    // Link up again after the panel restarted without reporting it (TFT upload); it is back on its
+    // first page at 9600
+    void reconnect() {
+        nexInit();
+        upgradeBaud();
+        setSleepTimeouts();
+        _asleep = false;
+        _currentPage = -1;
+        forceResync();
+        showBaudRate();
+    }
+
+    // Handle frames the panel sent since the last call (page changes, sleep/wake, touches)
+    void poll() {
+        nexLoop(nullptr);
+
+        if (_baudFallbackDue) {
+            // The panel stopped answering at the fast rate, e.g. it rebooted back to 9600
+            nexSetBaud(NEX_DEFAULT_BAUD); // Fails whatever is still queued
+            _baudFallbackDue = false;
+            _consecutiveTimeouts = 0;
+            forceResync();
+            showBaudRate();
+        }
+
+        if (_sleepTimeoutsDue) {
+            _sleepTimeoutsDue = false;
+            setSleepTimeouts();
+        }
+
+        // Touch navigation happens on the panel alone, so ask which page is open
+        if (!_asleep && !nexTransparentActive() && Clock::hasElapsed(_lastPagePoll, Config::DISPLAY_PAGE_POLL_MS)) {
+            _lastPagePoll = Clock::nowMs();
+            nexGetPage(nullptr, onCommandDone, this);
+        }
+
+        if (_pageOpened) {
+            _pageOpened = false; // Rendered from poll(), not from inside nexLoop
+            renderPage();
+        }
+
+        if (Clock::hasElapsed(_linkWindowStart, Config::DISPLAY_LINK_WINDOW_MS)) {
+            _linkWindowStart = Clock::nowMs();
+            sampleLink();
+        }
+
+        if (_wokeUp) {
+            _wokeUp = false;
+            sendQueued(true); // Everything held while asleep, in one burst
+        } else {
+            sendQueued(false);
+        }
+    }
+
+    // Send every due write now, ignoring the byte budget (before blocking for a while)
+    void flush() { sendQueued(true); }
+
+    // True if writes to the page go out now (also while the open page is still unknown)
+    bool isPageShown(uint8_t page) const { return _currentPage < 0 || _currentPage == page; }
+
+    // Called whenever the page opens, to refresh content that is only computed while the page is
+    // on screen
+    void onPageOpen(uint8_t page, PageRenderer renderer, void *ptr) {
+        int8_t index = pageIndex(page);
+        if (index < 0) return;
+        _renderers[index] = {renderer, ptr};
+    }
+
+    int16_t getCurrentPage() const { return _currentPage; } // -1 until the panel reports one
+    bool isAsleep() const { return _asleep; }
+    uint32_t getCommandErrors() const { return _commandErrors; }
+    uint32_t getBaudRate() const { return nexGetBaud(); }
+
     void showWifiConnecting(uint16_t attempt = 0) {
-        show("wifiConn");
-        String msg = "Waiting for Wi-Fi connection...";
-        if (attempt > 1) msg += " [" + String(attempt) + "]";
-        updateTextElement("start.wifiConn", msg);
+        showOnStart("wifiConn");
+        _text.clear();
+        _text.print("Waiting for Wi-Fi connection...");
+        if (attempt > 1) {
+            _text.print(" [");
+            _text.print(attempt);
+            _text.print(']');
+        }
+        updateTextElement("start.wifiConn", _text.c_str());
     }
     void showWifiConnected(const char *ssid, const IPAddress &ip) {
-        show("wifiConn");
-        updateTextElement("start.wifiConn", String("Connected to ") + ssid + "!");
-        updateTextElement("details.ssid", String("SSID: ") + ssid);
-        updateTextElement("details.ipAddress", String("IP: ") + ip.toString());
+        showOnStart("wifiConn");
+        _text.clear();
+        _text.print("Connected to ");
+        _text.print(ssid);
+        _text.print('!');
+        updateTextElement("start.wifiConn", _text.c_str());
+        _text.clear();
+        _text.print("SSID: ");
+        _text.print(ssid);
+        updateTextElement("details.ssid", _text.c_str(), Priority::BACKGROUND);
+        _text.clear();
+        _text.print("IP: ");
+        _text.print(ip);
+        updateTextElement("details.ipAddress", _text.c_str(), Priority::BACKGROUND);
     }
 
     void showTimeSyncing() {
-        show("timeSync");
+        showOnStart("timeSync");
         updateTextElement("start.timeSync", "Synchronising time...");
     }
     void showTimeSynced() {
-        show("timeSync");
+        showOnStart("timeSync");
         updateTextElement("start.timeSync", "Synchronised with NTP pool!");
     }
 
     void showDhtInitializing() {
-        show("dhtSensor");
+        showOnStart("dhtSensor");
         updateTextElement("start.dhtSensor", "Initialising DHT22 sensor...");
     }
     void showDhtInitialized() {
-        show("dhtSensor");
+        showOnStart("dhtSensor");
         updateTextElement("start.dhtSensor", "DHT22 sensor ready!");
     }
 
     void showThingsBoardSuccess() {
         // Show active upload indicator on details page
-        updateTextElement("details.uploadStatus", "↗ Uploading to ThingsBoard");
+        updateTextElement("details.uploadStatus", "↗ Uploading to ThingsBoard", Priority::BACKGROUND);
     }
-    void showThingsBoardError(const String &error) {
+    void showThingsBoardError(const char *error) {
         // Show error on details page
-        updateTextElement("details.uploadStatus", "✗ Upload failed: " + error);
+        _text.clear();
+        _text.print("✗ Upload failed: ");
+        _text.print(error);
+        updateTextElement("details.uploadStatus", _text.c_str(), Priority::BACKGROUND);
+    }
+
+    void showPanelUpdateResult(bool ok, uint32_t sent, uint32_t total, uint32_t bytesPerSecond) {
+        _text.clear();
+        if (ok) {
+            _text.print("Panel updated: ");
+            _text.print(total / 1024);
+            _text.print(" KB at ");
+        } else {
+            _text.print("Panel update failed at ");
+            _text.print(sent / 1024);
+            _text.print('/');
+            _text.print(total / 1024);
+            _text.print(" KB, ");
+        }
+        _text.print(bytesPerSecond / 1024.0, 1);
+        _text.print(" KB/s");
+        updateTextElement("details.panelUpdate", _text.c_str(), Priority::BACKGROUND);
     }
 
     /* ---------- Main page ---------- */
     void showMain() {
-        sendCmd("page main");
+        showPage("main");
         initializeStatusIndicators();
     }
 
     void initializeStatusIndicators() {
         // Initialize all indicators to normal state (hide all warning indicators)
-        hide("indoorIndWarn"); // Indoor conditions
-        hide("energyIndWarn"); // Energy usage
-        hide("airIndWarn");    // Air quality
+        setMainIndicator("indoorIndWarn", false); // Indoor conditions
+        setMainIndicator("energyIndWarn", false); // Energy usage
+        setMainIndicator("airIndWarn", false);    // Air quality
     }
     void updateClock(const char *hhmmss) {
-        updateTextElement("time", hhmmss);
+        updateTextElement("time", hhmmss, Priority::BACKGROUND);
+    }
+
+    // Set rtc0..rtc5 (year to second) from local time; rtc6, the weekday, is derived by the panel.
+    // Sent ahead of the write queue so the seconds are not delayed.
+    void setPanelClock(const struct tm &tm) {
+        const int values[] = {tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec};
+        _panelClock = PanelClock::SETTING;
+        for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+            _cmd.clear();
+            _cmd.print("rtc");
+            _cmd.print(i);
+            _cmd.print('=');
+            _cmd.print(values[i]);
+            terminate();
+            _clockTag = nexSendBuffer((const uint8_t *)_cmd.c_str(), _cmd.length(), onClockSet, this);
+            if (!_clockTag) {
+                handleRefused();
+                _panelClock = PanelClock::UNKNOWN; // Set again on the next sync
+                return;
+            }
+        }
     }
+    PanelClock getPanelClock() const { return _panelClock; }
 
     /* ---------- New specific object updates ---------- */
-    void updateOutdoorTemp(const String &text) {
+    void updateOutdoorTemp(const char *text) {
         updateTextElement("main.outTemp", text);
     }
-    void updateOutdoorRh(const String &text) {
+    void updateOutdoorRh(const char *text) {
         updateTextElement("main.outRh", text);
     }
-    void updateIndoorTemp(const String &text) {
+    void updateIndoorTemp(const char *text) {
         updateTextElement("main.inTemp", text);
     }
-    void updateIndoorRh(const String &text) {
+    void updateIndoorRh(const char *text) {
         updateTextElement("main.inRh", text);
     }
-    void updateIndoorStatus(const String &text) {
+    void updateIndoorStatus(const char *text) {
         updateTextElement("main.inStatus", text);
     }
-    void updateCurrentDraw(const String &text) {
+    void updateCurrentDraw(const char *text) {
         updateTextElement("main.currentDraw", text);
     }
-    void updateDailyEstimate(const String &text) {
+    void updateDailyEstimate(const char *text) {
         updateTextElement("main.dailyEst", text);
     }
-    void updateEnergyStatus(const String &text) {
+    void updateEnergyStatus(const char *text) {
         updateTextElement("main.energyStatus", text);
     }
-    void updateCoValue(const String &text) {
+    void updateCoValue(const char *text) {
         updateTextElement("main.coVal", text);
     }
-    void updateCoStatus(const String &text) {
+    void updateCoStatus(const char *text) {
         updateTextElement("main.coStatus", text);
     }
-    void updateOzoneStatus(const String &text) {
+    void updateOzoneStatus(const char *text) {
         updateTextElement("main.ozoneStatus", text);
     }
 
     /* -------- Status Indicators --------- */
     void updateIndoorIndicator(bool isNormal) {
-        if (isNormal) {
-            hide("indoorIndWarn"); // Hide frowny face for indoor conditions
-        } else {
-            show("indoorIndWarn"); // Show frowny face for indoor conditions
-        }
+        setMainIndicator("indoorIndWarn", !isNormal); // Frowny face for indoor conditions
     }
 
     void updateEnergyIndicator(bool isNormal) {
-        if (isNormal) {
-            hide("energyIndWarn"); // Hide frowny face for energy usage
-        } else {
-            show("energyIndWarn"); // Show frowny face for energy usage
-        }
+        setMainIndicator("energyIndWarn", !isNormal); // Frowny face for energy usage
     }
 
     void updateAirQualityIndicator(bool isNormal) {
-        if (isNormal) {
-            hide("airIndWarn"); // Hide frowny face for air quality
-        } else {
-            show("airIndWarn"); // Show frowny face for air quality
-        }
+        setMainIndicator("airIndWarn", !isNormal); // Frowny face for air quality
     }
 
     /* -------- Details page --------- */
+    void showBaudRate() {
+        _text.clear();
+        _text.print("Display Link: ");
+        _text.print(nexGetBaud());
+        _text.print(" baud");
+        updateTextElement("details.baudRate", _text.c_str(), Priority::BACKGROUND);
+    }
     void showLocation(double lat, double lon) {
-        updateTextElement("details.latitude", String("Latitude: ") + String(lat, 15));
-        updateTextElement("details.longitude", String("Longitude: ") + String(lon, 15));
+        _text.clear();
+        _text.print("Latitude: ");
+        _text.print(lat, 15);
+        updateTextElement("details.latitude", _text.c_str(), Priority::BACKGROUND);
+        _text.clear();
+        _text.print("Longitude: ");
+        _text.print(lon, 15);
+        updateTextElement("details.longitude", _text.c_str(), Priority::BACKGROUND);
     }
     void updateCoDetails(float voltage, uint16_t analogReading) {
-        updateTextElement("details.coDetails",
-                          String("CO: ") + String(voltage, 2) + "V (ADC: " + String(analogReading) + ")");
+        _text.clear();
+        _text.print("CO: ");
+        _text.print(voltage, 2);
+        _text.print("V (ADC: ");
+        _text.print(analogReading);
+        _text.print(')');
+        updateTextElement("details.coDetails", _text.c_str(), Priority::BACKGROUND);
     }
 
     /* -------- Heat Load page ------- */
-    void updateHeatLoadTotal(const String &value) {
-        updateTextElement("heatload.total", value);
+    void updateHeatLoadTotal(const char *value) {
+        updateTextElement("heatload.total", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadSensible(const String &value) {
-        updateTextElement("heatload.sensible", value);
+    void updateHeatLoadSensible(const char *value) {
+        updateTextElement("heatload.sensible", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadLatent(const String &value) {
-        updateTextElement("heatload.latent", value);
+    void updateHeatLoadLatent(const char *value) {
+        updateTextElement("heatload.latent", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadIndoor(const String &value) {
-        updateTextElement("heatload.indoor", value);
+    void updateHeatLoadIndoor(const char *value) {
+        updateTextElement("heatload.indoor", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadOutdoor(const String &value) {
-        updateTextElement("heatload.outdoor", value);
+    void updateHeatLoadOutdoor(const char *value) {
+        updateTextElement("heatload.outdoor", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadDifferences(const String &value) {
-        updateTextElement("heatload.differences", value);
+    void updateHeatLoadDifferences(const char *value) {
+        updateTextElement("heatload.differences", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadThresholdOn(const String &value) {
-        updateTextElement("heatload.thresholdOn", value);
+    void updateHeatLoadThresholdOn(const char *value) {
+        updateTextElement("heatload.thresholdOn", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadThresholdOff(const String &value) {
-        updateTextElement("heatload.thresholdOff", value);
+    void updateHeatLoadThresholdOff(const char *value) {
+        updateTextElement("heatload.thresholdOff", value, Priority::BACKGROUND);
     }
-    void updateHeatLoadRecommendation(const String &value) {
-        updateTextElement("heatload.recommendation", value);
+    void updateHeatLoadRecommendation(const char *value) {
+        updateTextElement("heatload.recommendation", value, Priority::BACKGROUND);
     }
 
+    /* -------- Trends page ------- */
+    // True if a transfer of count values can go out now: the panel is awake with the trends page
+    // open, no transfer is in flight, no alert or sensor write is due, and the tick's byte budget has room for it
+    bool canStreamWaveform(uint16_t count) {
+        if (_asleep || !isPageShown(Config::DISPLAY_PAGE_TRENDS) || nexTransparentActive()) return false;
+        for (const PendingWrite &entry : _pending) {
+            if (isDue(entry) && entry.priority < Priority::BACKGROUND) return false;
+        }
+        refillBudget();
+        size_t needed = count + ADDT_CMD_BYTES;
+        return needed <= _byteBudget || _byteBudget >= Config::DISPLAY_TICK_BYTE_BUDGET;
+    }
+
+    // values must stay valid until canStreamWaveform() allows the next transfer
+    void streamWaveform(Waveform waveform, uint8_t channel, const uint8_t *values, uint16_t count) {
+        spend(count + ADDT_CMD_BYTES);
+        this->waveform(waveform).addValues(channel, values, count, onWaveformDone, this);
+    }
+
+    void clearWaveform(Waveform waveform, uint8_t channel) {
+        this->waveform(waveform).clearChannel(channel, onCommandDone, this);
+    }
+
+    // Transfers that failed; the graphs are out of step with the history until redrawn
+    uint32_t getWaveformFailures() const { return _waveformFailures; }
+
+    /* -------- Shadow cache --------- */
+    // Forget every cached element value so the next write of each one goes out on the wire
+    void forceResync() {
+        memset(_shadow, 0, sizeof(_shadow));
+    }
+
+    uint32_t getSkippedWrites() const { return _skippedWrites; }
+    uint32_t getSkippedBytes() const { return _skippedBytes; }
+    /* -------- Write queue --------- */
+    uint32_t getDeferredWrites() const { return _deferredWrites; }   // Queued for a closed page
+    uint32_t getCoalescedWrites() const { return _coalescedWrites; } // Replaced before being sent
+    uint8_t getQueueDepth() const { return _queueDepth; }
+    bool isLinkIdle() const { return nexPendingCommands() == 0 && !nexTransparentActive(); } // Nothing awaits a reply
+    uint8_t getMaxQueueDepth() const { return _maxQueueDepth; }
+    uint32_t getAverageLatencyMs() const { return _sentWrites ? _totalLatencyMs / _sentWrites : 0; }
+    uint32_t getMaxLatencyMs() const { return _maxLatencyMs; }
+    /* -------- Link usage --------- */
+    const LinkUsage &getLinkLastWindow() const { return _linkLast; } // Last complete window
+    const LinkUsage &getLinkPeakWindow() const { return _linkPeak; } // Busiest window (send time)
+
+    /* -------- Sleep --------- */
+    uint32_t getSleepAvoidedWrites() const { return _sleepAvoidedWrites; } // Replaced while the panel slept
+    uint32_t getWakeReplayedWrites() const { return _wakeReplayedWrites; } // Held while asleep, then sent
+
 private:
-    static void sendCmd(const char *cmd) { ::sendCommand(cmd); }
-    static void show(const char *id) { sendCmd((String("vis ") + id + ",1").c_str()); }
-    static void hide(const char *id) { sendCmd((String("vis ") + id + ",0").c_str()); }
+    struct ShadowEntry {
+        uint32_t key;   // Hash of "<element>.<attribute>", 0 marks an empty slot
+        uint32_t value; // Hash of the value last sent to that element
+    };
+
+    // Latest value submitted for an element and not sent yet. The writes for a closed page form
+    // its dirty set; the others drain in priority order within each tick's byte budget.
+    struct PendingWrite {
+        const char *element; // nullptr marks a free slot
+        int16_t page;        // Page the element is on, -1 if unknown
+        Priority priority;
+        bool local;          // Unqualified name, addresses whichever page is open
+        bool visibility;     // "vis" command, text holds "0" or "1"
+        bool heldAsleep;     // Due when the panel woke up, replayed on waking
+        uint32_t queuedAt;   // When the write became due
+        char text[Config::DISPLAY_TEXT_BUFFER_SIZE];
+    };
+
+    struct PageInfo {
+        const char *name;
+        uint8_t id;
+    };
+
+    struct RendererEntry {
+        PageRenderer renderer;
+        void *ptr;
+    };
+
+    static constexpr uint8_t PAGE_COUNT = 5;
+
+    static const PageInfo &pageInfo(uint8_t index) {
+        static const PageInfo pages[PAGE_COUNT] = {
+            {"start", Config::DISPLAY_PAGE_START},
+            {"main", Config::DISPLAY_PAGE_MAIN},
+            {"details", Config::DISPLAY_PAGE_DETAILS},
+            {"heatload", Config::DISPLAY_PAGE_HEATLOAD},
+            {"trends", Config::DISPLAY_PAGE_TRENDS},
+        };
+        return pages[index];
+    }
+
+    static int8_t pageIndex(uint8_t page) {
+        for (uint8_t i = 0; i < PAGE_COUNT; i++) {
+            if (pageInfo(i).id == page) return i;
+        }
+        return -1;
+    }
+
+    // Page id for a page name, or for the "<page>." prefix of an element; -1 if unqualified
+    static int16_t pageIdOf(const char *name, size_t len) {
+        for (uint8_t i = 0; i < PAGE_COUNT; i++) {
+            const char *pageName = pageInfo(i).name;
+            if (strlen(pageName) == len && strncmp(pageName, name, len) == 0) return pageInfo(i).id;
+        }
+        return -1;
+    }
+    static int16_t pageOf(const char *element) {
+        const char *dot = strchr(element, '.');
+        return dot ? pageIdOf(element, dot - element) : -1;
+    }
+
+    static void onNexEvent(const NexEvent *event, void *ptr) {
+        static_cast<DisplayManager *>(ptr)->handleEvent(*event);
+    }
 
-    // Helper method to reduce string concatenation overhead
-    static void updateTextElement(const String &element, const String &text) {
-        sendCmd((element + ".txt=\"" + text + "\"").c_str());
+    void handleEvent(const NexEvent &event) {
+        switch (event.type) {
+        case NEX_EVT_PAGE:
+            setCurrentPage(event.page_id);
+            break;
+        case NEX_EVT_SLEEP:
+            _asleep = true;
+            break;
+        case NEX_EVT_WAKE:
+            if (_asleep) wake();
+            break;
+        case NEX_EVT_STARTUP:
+        case NEX_EVT_READY:
+            // Panel rebooted and is back to its HMI defaults
+            _asleep = false;
+            _currentPage = -1;
+            _sleepTimeoutsDue = true; // Sent from poll(), not from inside nexLoop
+            forceResync();
+            break;
+        default:
+            break;
+        }
+    }
+
+    void sampleLink() {
+        NexLinkStats stats;
+        nexGetLinkStats(&stats);
+        _linkLast = {stats.tx_bytes - _linkTotal.tx_bytes, stats.rx_bytes - _linkTotal.rx_bytes,
+                     stats.tx_commands - _linkTotal.tx_commands, stats.tx_wire_ms - _linkTotal.tx_wire_ms,
+                     stats.rx_wire_ms - _linkTotal.rx_wire_ms};
+        _linkTotal = stats;
+        if (_linkLast.txWireMs >= _linkPeak.txWireMs) _linkPeak = _linkLast;
+    }
+
+    // Writes held while asleep become due; latency counts from waking, like from a page opening
+    void wake() {
+        _asleep = false;
+        _wokeUp = true; // Sent from poll(), not from inside nexLoop
+
+        uint32_t now = millis();
+        for (PendingWrite &entry : _pending) {
+            if (!isDue(entry)) continue;
+            entry.queuedAt = now;
+            entry.heldAsleep = true; // Counted once it reaches the wire
+        }
+    }
+
+    void setSleepTimeouts() {
+        if (Config::DISPLAY_SLEEP_TIMEOUT_S) {
+            _cmd.clear();
+            _cmd.print("thsp=");
+            _cmd.print(max(Config::DISPLAY_SLEEP_TIMEOUT_S, (uint16_t)3)); // Shortest the panel accepts
+            sendBuffer();
+        }
+        sendCmd(Config::DISPLAY_WAKE_ON_TOUCH ? "thup=1" : "thup=0");
+    }
+
+    static void onClockSet(uint16_t tag, bool ok, uint8_t code, void *ptr) {
+        static_cast<DisplayManager *>(ptr)->handleClockResult(tag, ok, code);
     }
+
+    void handleClockResult(uint16_t tag, bool ok, uint8_t code) {
+        if (_panelClock != PanelClock::SETTING) return; // An earlier register already failed
+
+        if (!ok && code == NEX_RET_CMD_TIMEOUT) {
+            handleCommandResult(ok, code);
+            _panelClock = PanelClock::UNKNOWN; // Link trouble says nothing about the RTC
+        } else if (!ok) {
+            _panelClock = PanelClock::MISSING; // rtcN is not a valid variable on this model
+        } else if (tag == _clockTag) {
+            _panelClock = PanelClock::RUNNING;
+        }
+    }
+
+    static void onWaveformDone(uint16_t, bool ok, uint8_t code, void *ptr) {
+        DisplayManager *self = static_cast<DisplayManager *>(ptr);
+        if (!ok) self->_waveformFailures++;
+        self->handleCommandResult(ok, code);
+    }
+
+    NexWaveform &waveform(Waveform waveform) {
+        return waveform == Waveform::CLIMATE ? _climateWaveform : _powerWaveform;
+    }
+
+    static void onCommandDone(uint16_t, bool ok, uint8_t code, void *ptr) {
+        static_cast<DisplayManager *>(ptr)->handleCommandResult(ok, code);
+    }
+
+    void handleCommandResult(bool ok, uint8_t code) {
+        if (ok) {
+            _consecutiveTimeouts = 0;
+            return;
+        }
+
+        // A rejected or unanswered write leaves the panel out of step with the shadow cache
+        _commandErrors++;
+        forceResync();
+
+        if (code != NEX_RET_CMD_TIMEOUT) {
+            _consecutiveTimeouts = 0;
+        } else if (++_consecutiveTimeouts >= Config::DISPLAY_BAUD_FALLBACK_TIMEOUTS &&
+                   nexGetBaud() != NEX_DEFAULT_BAUD) {
+            _baudFallbackDue = true; // Switched from poll(), not from inside nexLoop
+        }
+    }
+
+    // Every reply slot was taken, so nothing went out; the shadow cache already holds the value
+    void handleRefused() {
+        _commandErrors++;
+        forceResync();
+    }
+
+    void upgradeBaud() {
+        // Also recovers a panel still at the fast rate after an MCU-only reset:
+        // the baud command is lost but the probe at the new rate is answered
+        if (Config::DISPLAY_BAUD && Config::DISPLAY_BAUD != NEX_DEFAULT_BAUD) {
+            nexSetBaud(Config::DISPLAY_BAUD);
+        }
+        _consecutiveTimeouts = 0;
+        _baudFallbackDue = false;
+    }
+
+    static constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    static constexpr uint32_t FNV_PRIME = 16777619u;
+    static constexpr size_t NEX_TERMINATOR_BYTES = 3; // 0xFF 0xFF 0xFF after every command
+    static constexpr size_t REFRESH_CMD_BYTES = 8 + NEX_TERMINATOR_BYTES; // "ref_stop" / "ref_star"
+    static constexpr size_t ADDT_CMD_BYTES = 16 + NEX_TERMINATOR_BYTES;   // "addt <id>,<ch>,<count>"
+
+    static uint32_t hash(const char *str, uint32_t h = FNV_OFFSET_BASIS) {
+        while (*str) {
+            h ^= (uint8_t)*str++;
+            h *= FNV_PRIME;
+        }
+        return h;
+    }
+
+    // Record value as the element's current state. Returns false if the panel already shows it.
+    bool shadowChanged(uint32_t key, uint32_t value, size_t cmdBytes) {
+        if (key == 0) key = 1; // Keep 0 free as the empty-slot marker
+
+        uint8_t slot = key % Config::DISPLAY_SHADOW_SLOTS;
+        for (uint8_t probe = 0; probe < Config::DISPLAY_SHADOW_SLOTS; probe++) {
+            ShadowEntry &entry = _shadow[slot];
+            if (entry.key == key) {
+                if (entry.value == value) {
+                    _skippedWrites++;
+                    _skippedBytes += cmdBytes + NEX_TERMINATOR_BYTES;
+                    return false;
+                }
+                entry.value = value;
+                return true;
+            }
+            if (entry.key == 0) {
+                entry = {key, value};
+                return true;
+            }
+            slot = (slot + 1) % Config::DISPLAY_SHADOW_SLOTS;
+        }
+        return true; // Table full, send uncached
+    }
+
+    // Sent ahead of the queue, which only holds writes to elements
+    void showPage(const char *page) {
+        _cmd.clear();
+        _cmd.print("page ");
+        _cmd.print(page);
+        sendBuffer();
+
+        // Reloading the page on screen resets its components too, so it counts as a page change
+        int16_t id = pageIdOf(page, strlen(page));
+        _currentPage = -1;
+        if (id >= 0) {
+            setCurrentPage(id);
+        } else {
+            forceResync();
+        }
+    }
+
+    // Whether opened by showPage() or by touch: components on the new page start from their HMI
+    // defaults, so nothing cached is trustworthy
+    void setCurrentPage(int16_t page) {
+        if (page == _currentPage) return;
+        _currentPage = page;
+        _pageOpened = true;
+        forceResync();
+
+        uint32_t now = millis();
+        for (PendingWrite &entry : _pending) {
+            if (!entry.element) continue;
+            if (entry.local && entry.page != page) {
+                // Meant for the page that just closed; its components reset when it reopens
+                releaseSlot(entry);
+            } else if (entry.page == page) {
+                entry.queuedAt = now; // Latency counts from the page opening
+            }
+        }
+    }
+
+    void renderPage() {
+        int8_t index = _currentPage < 0 ? -1 : pageIndex(_currentPage);
+        if (index >= 0 && _renderers[index].renderer) {
+            _renderers[index].renderer(_renderers[index].ptr);
+        }
+    }
+
+    // Queue the value, replacing any value still waiting for the same element. Element names must
+    // outlive the queue (string literals).
+    void submit(const char *element, bool visibility, const char *text, Priority priority) {
+        int16_t page = pageOf(element);
+        bool local = page < 0;
+        if (local) page = _currentPage;
+
+        PendingWrite *slot = nullptr;
+        for (PendingWrite &entry : _pending) {
+            if (entry.element && entry.visibility == visibility && strcmp(entry.element, element) == 0) {
+                slot = &entry;
+                _coalescedWrites++; // The earlier value is never sent
+                if (_asleep && isDue(entry)) _sleepAvoidedWrites++;
+                break;
+            }
+            if (!entry.element && !slot) slot = &entry;
+        }
+        if (!slot) {
+            writeElement(element, visibility, text); // Queue full, write through (even while asleep)
+            return;
+        }
+
+        if (!slot->element) {
+            slot->queuedAt = millis();
+            slot->heldAsleep = false;
+            if (++_queueDepth > _maxQueueDepth) _maxQueueDepth = _queueDepth;
+        }
+        slot->element = element;
+        slot->page = page;
+        slot->priority = priority;
+        slot->local = local;
+        slot->visibility = visibility;
+        strncpy(slot->text, text, sizeof(slot->text) - 1);
+        slot->text[sizeof(slot->text) - 1] = '\0';
+        if (!isPageShown(page)) _deferredWrites++;
+    }
+
+    void releaseSlot(PendingWrite &entry) {
+        entry.element = nullptr;
+        _queueDepth--;
+    }
+
+    bool isDue(const PendingWrite &entry) const {
+        return entry.element && (entry.page < 0 || isPageShown(entry.page));
+    }
+
+    // Most urgent due write, oldest first within a priority
+    PendingWrite *nextDue() {
+        PendingWrite *next = nullptr;
+        uint32_t now = millis();
+        for (PendingWrite &entry : _pending) {
+            if (!isDue(entry)) continue;
+            if (!next || entry.priority < next->priority ||
+                (entry.priority == next->priority && now - entry.queuedAt > now - next->queuedAt)) {
+                next = &entry;
+            }
+        }
+        return next;
+    }
+
+    static size_t commandBytes(const PendingWrite &entry) {
+        // "vis <id>,<0|1>" or "<element>.txt=\"<text>\"", escapes not counted
+        size_t bytes = entry.visibility ? strlen(entry.element) + 6 : strlen(entry.element) + strlen(entry.text) + 7;
+        return bytes + NEX_TERMINATOR_BYTES;
+    }
+
+    // The budget refills at the wire rate, so a tick never queues more than the UART can drain
+    void refillBudget() {
+        uint32_t elapsed = min(Clock::elapsedMs(_lastRefill), (uint64_t)1000);
+        uint32_t earned = elapsed * (nexGetBaud() / 10) / 1000; // 10 bits per byte on the wire
+        if (earned == 0) return; // Keep the fraction for the next tick
+        _lastRefill = Clock::nowMs();
+        _byteBudget = min(_byteBudget + earned, (uint32_t)Config::DISPLAY_TICK_BYTE_BUDGET);
+    }
+
+    void spend(size_t bytes) { _byteBudget -= min((uint32_t)bytes, _byteBudget); }
+
+    // Send due writes, most urgent first, while the budget lasts. Several writes in one tick are
+    // wrapped in ref_stop/ref_star so the panel repaints once.
+    void sendQueued(bool unlimited) {
+        refillBudget();
+        // Held rather than blocking on the transfer; a sleeping panel gets the latest values on waking
+        if (_queueDepth == 0 || _asleep || nexTransparentActive()) return;
+
+        uint8_t due = 0;
+        for (const PendingWrite &entry : _pending) {
+            if (isDue(entry)) due++;
+        }
+
+        bool wrapped = false;
+        while (PendingWrite *entry = nextDue()) {
+            size_t needed = commandBytes(*entry);
+            if (due > 1 || wrapped) needed += wrapped ? REFRESH_CMD_BYTES : 2 * REFRESH_CMD_BYTES;
+            // A write larger than the whole budget goes out once the budget is full
+            if (!unlimited && needed > _byteBudget && _byteBudget < Config::DISPLAY_TICK_BYTE_BUDGET) break;
+            // Held while the library could refuse the write, ref_stop or ref_star for want of reply slots
+            if (nexPendingCommands() + 3 > NEX_CMD_QUEUE_SIZE) break;
+
+            if (due > 1 && !wrapped) {
+                sendCmd("ref_stop");
+                spend(REFRESH_CMD_BYTES);
+                wrapped = true;
+            }
+
+            uint32_t latency = millis() - entry->queuedAt;
+            _totalLatencyMs += latency;
+            if (latency > _maxLatencyMs) _maxLatencyMs = latency;
+            _sentWrites++;
+
+            size_t written = writeElement(entry->element, entry->visibility, entry->text);
+            spend(written);
+            if (written && entry->heldAsleep) _wakeReplayedWrites++;
+            releaseSlot(*entry);
+            due--;
+        }
+
+        if (wrapped) {
+            sendCmd("ref_star");
+            spend(REFRESH_CMD_BYTES);
+        }
+    }
+
+    // Returns the bytes written, 0 if the panel already shows the value
+    size_t writeElement(const char *element, bool visibility, const char *text) {
+        return visibility ? writeVisible(element, text[0] == '1') : writeText(element, text);
+    }
+
+    // Queued without waiting for the panel's acknowledgement; the result arrives via onCommandDone
+    void sendCmd(const char *cmd) {
+        Tracer::Span span("display.cmd");
+        if (!nexSendCommand(cmd, onCommandDone, this)) handleRefused();
+    }
+
+    void terminate() {
+        for (size_t i = 0; i < NEX_TERMINATOR_BYTES; i++) {
+            _cmd.write(0xFF);
+        }
+    }
+
+    // Terminate the command in _cmd and send it in a single write. Returns its length.
+    size_t sendBuffer() {
+        terminate();
+        if (!nexSendBuffer((const uint8_t *)_cmd.c_str(), _cmd.length(), onCommandDone, this)) {
+            handleRefused();
+            return 0;
+        }
+        return _cmd.length();
+    }
+
+    // Writes to "<page>.<name>" elements wait until that page opens
+    void setVisible(const char *id, bool visible, Priority priority) {
+        submit(id, true, visible ? "1" : "0", priority);
+    }
+    void show(const char *id, Priority priority = Priority::SENSOR) { setVisible(id, true, priority); }
+    void hide(const char *id, Priority priority = Priority::SENSOR) { setVisible(id, false, priority); }
+
+    // vis only reaches components of the page on screen, so a start page indicator is dropped
+    // once main is up; the panel would reject it (and a rejected write resyncs everything)
+    void showOnStart(const char *id) {
+        if (isPageShown(Config::DISPLAY_PAGE_START)) show(id);
+    }
+    // Likewise for the warning indicators on main; AlertManager redraws them whenever main opens
+    void setMainIndicator(const char *id, bool visible) {
+        if (isPageShown(Config::DISPLAY_PAGE_MAIN)) setVisible(id, visible, Priority::ALERT);
+    }
+
+    void updateTextElement(const char *element, const char *text, Priority priority = Priority::SENSOR) {
+        submit(element, false, text, priority);
+    }
+
+    size_t writeVisible(const char *id, bool visible) {
+        // "vis <id>,<0|1>"
+        if (!shadowChanged(hash(".vis", hash(id)), visible, strlen(id) + 6)) return 0;
+        _cmd.clear();
+        _cmd.print("vis ");
+        _cmd.print(id);
+        _cmd.print(visible ? ",1" : ",0");
+        return sendBuffer();
+    }
+
+    // Builds the command in place with quotes and backslashes escaped; overlong text is truncated
+    size_t writeText(const char *element, const char *text) {
+        // "<element>.txt=\"<text>\""
+        if (!shadowChanged(hash(".txt", hash(element)), hash(text), strlen(element) + strlen(text) + 7)) return 0;
+
+        _cmd.clear();
+        _cmd.print(element);
+        _cmd.print(".txt=\"");
+        // Leave room for an escaped character, the closing quote and the terminator
+        for (; *text && _cmd.length() + 3 + NEX_TERMINATOR_BYTES <= _cmd.capacity(); text++) {
+            if (*text == '"' || *text == '\\') _cmd.print('\\');
+            _cmd.print(*text);
+        }
+        _cmd.print('"');
+        return sendBuffer();
+    }
+
+    TextBuffer<Config::DISPLAY_CMD_BUFFER_SIZE> _cmd;  // Command being sent, terminator included
+    TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> _text; // Text being composed for updateTextElement
+
+    ShadowEntry _shadow[Config::DISPLAY_SHADOW_SLOTS] = {};
+    uint32_t _skippedWrites = 0;
+    uint32_t _skippedBytes = 0;
+
+    PendingWrite _pending[Config::DISPLAY_QUEUE_SLOTS] = {};
+    uint8_t _queueDepth = 0;
+    uint8_t _maxQueueDepth = 0;
+    uint32_t _deferredWrites = 0;
+    uint32_t _coalescedWrites = 0;
+    uint32_t _sentWrites = 0;
+    uint32_t _totalLatencyMs = 0;
+    uint32_t _maxLatencyMs = 0;
+    uint32_t _byteBudget = Config::DISPLAY_TICK_BYTE_BUDGET;
+    uint64_t _lastRefill = 0;
+
+    RendererEntry _renderers[PAGE_COUNT] = {};
+    uint64_t _lastPagePoll = 0;
+    bool _pageOpened = false;
+
+    NexWaveform _climateWaveform{Config::DISPLAY_PAGE_TRENDS, Config::TREND_CLIMATE_WAVEFORM_ID, "climate"};
+    NexWaveform _powerWaveform{Config::DISPLAY_PAGE_TRENDS, Config::TREND_POWER_WAVEFORM_ID, "power"};
+    uint32_t _waveformFailures = 0;
+
+    PanelClock _panelClock = PanelClock::UNKNOWN;
+    uint16_t _clockTag = 0; // Tag of the last register write (rtc5)
+
+    int16_t _currentPage = -1;
+    NexLinkStats _linkTotal = {}; // Counters at the start of the current window
+    LinkUsage _linkLast = {};
+    LinkUsage _linkPeak = {};
+    uint64_t _linkWindowStart = 0;
+
+    bool _asleep = false;
+    bool _wokeUp = false;
+    bool _sleepTimeoutsDue = false;
+    uint32_t _sleepAvoidedWrites = 0;
+    uint32_t _wakeReplayedWrites = 0;
+    uint32_t _commandErrors = 0;
+
+    uint8_t _consecutiveTimeouts = 0;
+    bool _baudFallbackDue = false;
 };
@@ -1,7 +1,12 @@
 #pragma once
+#include "Clock.h"
 #include "Config.h"
 #include "DisplayManager.h"
+#include "EventBus.h"
+#include "Scheduler.h"
 #include "SensorHelper.h"
+#include "TextBuffer.h"
+#include "WarmState.h"
 #include "WeatherHelper.h"
 
 enum class ACPowerState {
@@ -16,37 +21,69 @@ public:
     explicit EnergyEstimator(DisplayManager &disp, SensorHelper &sensors, WeatherHelper &weather)
         : _disp(disp), _sensors(sensors), _weather(weather), _acState(ACPowerState::OFF) {}
 
-    void begin() {
+    void begin(Scheduler &scheduler, EventBus &events) {
         // Initialize energy estimator with AC off
         _acState = ACPowerState::OFF;
-        _lastStateChange = millis();
+        _lastStateChange = Clock::nowMs();
         _totalRuntimeToday = 0;
         _dailyEnergyConsumed = 0.0;
-        _lastDayReset = millis();
+        _lastDayReset = Clock::nowMs();
+
+        // The heat load page is rarely open: only render it while it is on screen
+        _disp.onPageOpen(Config::DISPLAY_PAGE_HEATLOAD, renderHeatLoad, this);
+
+        // Recompute as soon as a new reading arrives; the timer still advances the AC state
+        _scheduler = &scheduler;
+        _events = &events;
+        _task = scheduler.add("energy", onCalculateTask, this);
+        events.subscribe(Event::INDOOR_SAMPLE, onInputChanged, this);
+        events.subscribe(Event::OUTDOOR_SAMPLE, onInputChanged, this);
     }
 
-    void poll() {
-        if (millis() - _lastCalculation >= Config::ENERGY_CALC_REFRESH_MS) {
-            updateACState();
-            calculateEnergyUsage();
-            trackDailyUsage();
-        }
+    void saveState(WarmState &state) const {
+        state.runtimeTodaySec = _totalRuntimeToday;
+        state.dayAgeMs = Clock::elapsedMs(_lastDayReset);
+        state.stateAgeMs = Clock::elapsedMs(_lastStateChange);
+        state.energyTodayKWh = _dailyEnergyConsumed;
+        state.acState = (uint8_t)_acState;
+    }
+
+    // After begin(): carry on with today's totals; the energy task redraws on its first run
+    void restoreState(const WarmState &state) {
+        _totalRuntimeToday = state.runtimeTodaySec;
+        _lastDayReset = Clock::nowMs() - state.dayAgeMs;
+        _lastStateChange = Clock::nowMs() - state.stateAgeMs;
+        _dailyEnergyConsumed = state.energyTodayKWh;
+        _acState = state.acState <= (uint8_t)ACPowerState::IDLE ? (ACPowerState)state.acState : ACPowerState::OFF;
+        _lastCalculation = Clock::nowMs(); // The time spent resetting is not counted
+    }
+
+    // Update the AC state and the energy figures now
+    void calculate() {
+        _inputsChanged = true;
+        refresh();
     }
 
+    // Power model recomputations, and timer runs that kept the previous model (nothing new to compute from)
+    uint32_t getRecalculations() const { return _recalculations; }
+    uint32_t getSkippedRecalculations() const { return _skippedRecalculations; }
+
     // Manual AC control methods
     void setACOn() {
         if (_acState == ACPowerState::OFF) {
             _acState = ACPowerState::STARTING;
-            _lastStateChange = millis();
+            _lastStateChange = Clock::nowMs();
+            inputChanged();
         }
     }
 
     void setACOff() {
         if (_acState != ACPowerState::OFF) {
             // Add runtime to today's total before turning off
-            _totalRuntimeToday += (millis() - _lastStateChange) / Config::MILLIS_TO_SECONDS; // seconds
+            _totalRuntimeToday += Clock::elapsedMs(_lastStateChange) / Config::MILLIS_TO_SECONDS; // seconds
             _acState = ACPowerState::OFF;
-            _lastStateChange = millis();
+            _lastStateChange = Clock::nowMs();
+            inputChanged();
         }
     }
 
@@ -57,7 +94,7 @@ public:
     float getTodaysRuntimeHours() const {
         uint32_t currentRuntime = _totalRuntimeToday;
         if (_acState != ACPowerState::OFF) {
-            currentRuntime += (millis() - _lastStateChange) / Config::MILLIS_TO_SECONDS;
+            currentRuntime += Clock::elapsedMs(_lastStateChange) / Config::MILLIS_TO_SECONDS;
         }
         return currentRuntime / Config::SECONDS_TO_HOURS;
     }
@@ -111,15 +148,31 @@ public:
     }
 
     // New methods for individual object updates
+    void printCurrentDraw(Print &out) const {
+        out.print("Current Usage: ");
+        out.print((int)_estimatedPowerWatts);
+        out.print(" W");
+    }
+
+    void printDailyEstimate(Print &out) const {
+        out.print("Daily: ");
+        out.print(_dailyEnergyKWh, 2);
+        out.print(" kWh/day");
+    }
+
     String getCurrentDrawString() const {
-        return "Current Usage: " + String((int)_estimatedPowerWatts) + " W";
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printCurrentDraw(text);
+        return text.c_str();
     }
 
     String getDailyEstimateString() const {
-        return "Daily: " + String(_dailyEnergyKWh, 2) + " kWh/day";
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printDailyEstimate(text);
+        return text.c_str();
     }
 
-    String getEnergyStatusString() const {
+    const char *getEnergyStatusString() const {
         // Check if AC is off first
         if (_acState == ACPowerState::OFF) {
             return "Status: AC Off";
@@ -143,10 +196,11 @@ public:
         return getCurrentHeatLoadWatts() < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD;
     }
 
-    // Get detailed heat load breakdown for configuration and monitoring
-    String getHeatLoadDetails() const {
+    // Detailed heat load breakdown for configuration and monitoring
+    void printHeatLoadDetails(Print &out) const {
         if (!_sensors.isDataValid() || isnan(_weather.getCurrentTemp()) || isnan(_weather.getCurrentHumidity())) {
-            return "Heat Load: INVALID DATA";
+            out.println("Heat Load: INVALID DATA");
+            return;
         }
 
         float indoorTemp = _sensors.getIndoorTemp();
@@ -167,46 +221,58 @@ public:
         float tempDiff = abs(outdoorTemp - indoorTemp);
         float humidityDiff = abs(outdoorHumidity - indoorHumidity);
 
-        // Build detailed report
-        String details = "";
-        details += "=== HEAT LOAD ANALYSIS ===\n";
-        details += "Total Heat Load: " + String((int)totalLoad) + "W\n";
-        details += "  - Sensible: " + String((int)sensibleLoad) + "W (" + String((int)sensiblePercent) + "%)\n";
-        details += "  - Latent: " + String((int)latentLoad) + "W (" + String((int)latentPercent) + "%)\n\n";
-
-        details += "=== CONDITIONS ===\n";
-        details += "Indoor: " + String(indoorTemp, 1) + "°C, " + String((int)indoorHumidity) + "%RH\n";
-        details += "Outdoor: " + String(outdoorTemp, 1) + "°C, " + String((int)outdoorHumidity) + "%RH\n";
-        details += "Temp Diff: " + String(tempDiff, 1) + "°C\n";
-        details += "Humidity Diff: " + String(humidityDiff, 1) + "%\n\n";
-
-        details += "=== AUTO THRESHOLDS ===\n";
-        details += "Auto ON: " + String((int)Config::AUTO_ON_HEAT_LOAD_THRESHOLD) + "W ";
-        details += (totalLoad > Config::AUTO_ON_HEAT_LOAD_THRESHOLD) ? "[WOULD START]" : "[below]";
-        details += "\nAuto OFF: " + String((int)Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) + "W ";
-        details += (totalLoad < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) ? "[WOULD STOP]" : "[above]";
-        details += "\n\n";
-
-        details += "=== RECOMMENDATIONS ===\n";
+        out.println("=== HEAT LOAD ANALYSIS ===");
+        out.print("Total Heat Load: ");
+        out.print((int)totalLoad);
+        out.println("W");
+        out.print("  - Sensible: ");
+        printLoadShare(out, sensibleLoad, sensiblePercent);
+        out.println();
+        out.print("  - Latent: ");
+        printLoadShare(out, latentLoad, latentPercent);
+        out.println();
+        out.println();
+
+        out.println("=== CONDITIONS ===");
+        out.print("Indoor: ");
+        printReportConditions(out, indoorTemp, indoorHumidity);
+        out.print("Outdoor: ");
+        printReportConditions(out, outdoorTemp, outdoorHumidity);
+        out.print("Temp Diff: ");
+        out.print(tempDiff, 1);
+        out.println("°C");
+        out.print("Humidity Diff: ");
+        out.print(humidityDiff, 1);
+        out.println("%");
+        out.println();
+
+        out.println("=== AUTO THRESHOLDS ===");
+        out.print("Auto ON: ");
+        out.print((int)Config::AUTO_ON_HEAT_LOAD_THRESHOLD);
+        out.println((totalLoad > Config::AUTO_ON_HEAT_LOAD_THRESHOLD) ? "W [WOULD START]" : "W [below]");
+        out.print("Auto OFF: ");
+        out.print((int)Config::AUTO_OFF_HEAT_LOAD_THRESHOLD);
+        out.println((totalLoad < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) ? "W [WOULD STOP]" : "W [above]");
+        out.println();
+
+        out.println("=== RECOMMENDATIONS ===");
         if (totalLoad < 200) {
-            details += "Very low load - consider higher AUTO_OFF threshold\n";
+            out.println("Very low load - consider higher AUTO_OFF threshold");
         } else if (totalLoad > 1500) {
-            details += "Very high load - verify room parameters\n";
+            out.println("Very high load - verify room parameters");
         }
 
         if (sensiblePercent > 80) {
-            details += "Mostly temperature-driven - check insulation\n";
+            out.println("Mostly temperature-driven - check insulation");
         } else if (latentPercent > 60) {
-            details += "High humidity load - check ventilation\n";
+            out.println("High humidity load - check ventilation");
         }
 
         if (tempDiff > 12) {
-            details += "Large temp difference - peak cooling needed\n";
+            out.println("Large temp difference - peak cooling needed");
         } else if (tempDiff < 3) {
-            details += "Small temp difference - minimal cooling\n";
+            out.println("Small temp difference - minimal cooling");
         }
-
-        return details;
     }
 
     // Update heat load details on Nextion display
@@ -235,23 +301,55 @@ public:
         float humidityDiff = abs(outdoorHumidity - indoorHumidity);
 
         // Update display components
-        _disp.updateHeatLoadTotal(String((int)totalLoad) + "W");
-        _disp.updateHeatLoadSensible(String((int)sensibleLoad) + "W (" + String((int)sensiblePercent) + "%)");
-        _disp.updateHeatLoadLatent(String((int)latentLoad) + "W (" + String((int)latentPercent) + "%)");
-
-        _disp.updateHeatLoadIndoor("In: " + String(indoorTemp, 1) + "°C " + String((int)indoorHumidity) + "%");
-        _disp.updateHeatLoadOutdoor("Out: " + String(outdoorTemp, 1) + "°C " + String((int)outdoorHumidity) + "%");
-        _disp.updateHeatLoadDifferences("ΔT:" + String(tempDiff, 1) + "°C ΔH:" + String(humidityDiff, 1) + "%");
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        text.print((int)totalLoad);
+        text.print('W');
+        _disp.updateHeatLoadTotal(text.c_str());
+
+        text.clear();
+        printLoadShare(text, sensibleLoad, sensiblePercent);
+        _disp.updateHeatLoadSensible(text.c_str());
+
+        text.clear();
+        printLoadShare(text, latentLoad, latentPercent);
+        _disp.updateHeatLoadLatent(text.c_str());
+
+        text.clear();
+        printConditions(text, "In: ", indoorTemp, indoorHumidity);
+        _disp.updateHeatLoadIndoor(text.c_str());
+
+        text.clear();
+        printConditions(text, "Out: ", outdoorTemp, outdoorHumidity);
+        _disp.updateHeatLoadOutdoor(text.c_str());
+
+        text.clear();
+        text.print("ΔT:");
+        text.print(tempDiff, 1);
+        text.print("°C ΔH:");
+        text.print(humidityDiff, 1);
+        text.print('%');
+        _disp.updateHeatLoadDifferences(text.c_str());
 
         // Threshold status
-        String onStatus = (totalLoad > Config::AUTO_ON_HEAT_LOAD_THRESHOLD) ? "WOULD START" : "below";
-        String offStatus = (totalLoad < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) ? "WOULD STOP" : "above";
-
-        _disp.updateHeatLoadThresholdOn("ON:" + String((int)Config::AUTO_ON_HEAT_LOAD_THRESHOLD) + "W " + onStatus);
-        _disp.updateHeatLoadThresholdOff("OFF:" + String((int)Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) + "W " + offStatus);
+        const char *onStatus = (totalLoad > Config::AUTO_ON_HEAT_LOAD_THRESHOLD) ? "WOULD START" : "below";
+        const char *offStatus = (totalLoad < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) ? "WOULD STOP" : "above";
+
+        text.clear();
+        text.print("ON:");
+        text.print((int)Config::AUTO_ON_HEAT_LOAD_THRESHOLD);
+        text.print("W ");
+        text.print(onStatus);
+        _disp.updateHeatLoadThresholdOn(text.c_str());
+
+        text.clear();
+        text.print("OFF:");
+        text.print((int)Config::AUTO_OFF_HEAT_LOAD_THRESHOLD);
+        text.print("W ");
+        text.print(offStatus);
+        _disp.updateHeatLoadThresholdOff(text.c_str());
 
         // Recommendations
-        String recommendation = "";
+        const char *recommendation;
         if (totalLoad < 200) {
             recommendation = "Very low load - raise AUTO_OFF";
         } else if (totalLoad > 1500) {
@@ -271,14 +369,15 @@ public:
         _disp.updateHeatLoadRecommendation(recommendation);
     }
 
-    // Get simplified heat load summary for display
-    String getHeatLoadSummary() const {
+    // Simplified heat load summary, e.g. "Heat Load: 850W (MED)"
+    void printHeatLoadSummary(Print &out) const {
         if (!_sensors.isDataValid() || isnan(_weather.getCurrentTemp()) || isnan(_weather.getCurrentHumidity())) {
-            return "Heat Load: No Data";
+            out.print("Heat Load: No Data");
+            return;
         }
 
         float totalLoad = getCurrentHeatLoadWatts();
-        String status = "";
+        const char *status;
 
         if (totalLoad > Config::AUTO_ON_HEAT_LOAD_THRESHOLD) {
             status = "HIGH";
@@ -288,51 +387,65 @@ public:
             status = "LOW";
         }
 
-        return "Heat Load: " + String((int)totalLoad) + "W (" + status + ")";
+        out.print("Heat Load: ");
+        out.print((int)totalLoad);
+        out.print("W (");
+        out.print(status);
+        out.print(')');
     }
 
-    // Get configuration recommendations based on current conditions
-    String getConfigRecommendations() const {
-        String recommendations = "";
-        recommendations += "=== CONFIGURATION RECOMMENDATIONS ===\n\n";
+    // Configuration recommendations based on current conditions
+    void printConfigRecommendations(Print &out) const {
+        out.println("=== CONFIGURATION RECOMMENDATIONS ===");
+        out.println();
 
         // Room size recommendations
         float roomVolume = Config::ROOM_AIR_VOLUME;
         float roomArea = Config::ROOM_SURFACE_AREA;
 
-        recommendations += "Current Room Config:\n";
-        recommendations += "- Volume: " + String(roomVolume, 0) + "m³\n";
-        recommendations += "- Surface Area: " + String(roomArea, 0) + "m²\n";
-        recommendations += "- Heat Transfer Coeff: " + String(Config::ROOM_HEAT_TRANSFER_COEFF, 1) + "\n\n";
+        out.println("Current Room Config:");
+        out.print("- Volume: ");
+        out.print(roomVolume, 0);
+        out.println("m³");
+        out.print("- Surface Area: ");
+        out.print(roomArea, 0);
+        out.println("m²");
+        out.print("- Heat Transfer Coeff: ");
+        out.println(Config::ROOM_HEAT_TRANSFER_COEFF, 1);
+        out.println();
 
         // Threshold recommendations based on room size
         float recommendedOnThreshold = roomVolume * 10.0; // ~10W per m³
         float recommendedOffThreshold = recommendedOnThreshold * 0.5;
 
-        recommendations += "Recommended Thresholds:\n";
-        recommendations += "- AUTO_ON_HEAT_LOAD_THRESHOLD: " + String((int)recommendedOnThreshold) + "W\n";
-        recommendations += "- AUTO_OFF_HEAT_LOAD_THRESHOLD: " + String((int)recommendedOffThreshold) + "W\n";
-        recommendations += "(Current: " + String((int)Config::AUTO_ON_HEAT_LOAD_THRESHOLD) + "W / ";
-        recommendations += String((int)Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) + "W)\n\n";
+        out.println("Recommended Thresholds:");
+        out.print("- AUTO_ON_HEAT_LOAD_THRESHOLD: ");
+        out.print((int)recommendedOnThreshold);
+        out.println("W");
+        out.print("- AUTO_OFF_HEAT_LOAD_THRESHOLD: ");
+        out.print((int)recommendedOffThreshold);
+        out.println("W");
+        printCurrentPair(out, Config::AUTO_ON_HEAT_LOAD_THRESHOLD, Config::AUTO_OFF_HEAT_LOAD_THRESHOLD);
 
         // AC power recommendations
         float minRecommendedPower = roomVolume * 15.0; // ~15W per m³
         float maxRecommendedPower = roomVolume * 25.0; // ~25W per m³
 
-        recommendations += "Recommended AC Power Range:\n";
-        recommendations += "- MIN: " + String((int)minRecommendedPower) + "W\n";
-        recommendations += "- MAX: " + String((int)maxRecommendedPower) + "W\n";
-        recommendations += "(Current: " + String((int)Config::AC_MIN_POWER_WATTS) + "W / ";
-        recommendations += String((int)Config::AC_MAX_POWER_WATTS) + "W)\n\n";
-
-        recommendations += "=== TUNING TIPS ===\n";
-        recommendations += "1. Monitor heat load for 1 week\n";
-        recommendations += "2. Note typical HIGH/MED/LOW values\n";
-        recommendations += "3. Set AUTO_ON = typical HIGH value\n";
-        recommendations += "4. Set AUTO_OFF = 50% of AUTO_ON\n";
-        recommendations += "5. Adjust based on comfort/efficiency\n";
-
-        return recommendations;
+        out.println("Recommended AC Power Range:");
+        out.print("- MIN: ");
+        out.print((int)minRecommendedPower);
+        out.println("W");
+        out.print("- MAX: ");
+        out.print((int)maxRecommendedPower);
+        out.println("W");
+        printCurrentPair(out, Config::AC_MIN_POWER_WATTS, Config::AC_MAX_POWER_WATTS);
+
+        out.println("=== TUNING TIPS ===");
+        out.println("1. Monitor heat load for 1 week");
+        out.println("2. Note typical HIGH/MED/LOW values");
+        out.println("3. Set AUTO_ON = typical HIGH value");
+        out.println("4. Set AUTO_OFF = 50% of AUTO_ON");
+        out.println("5. Adjust based on comfort/efficiency");
     }
 
     // Calculate sensible heat load based on temperature difference (public for monitoring)
@@ -368,6 +481,45 @@ public:
     }
 
 private:
+    static uint32_t onCalculateTask(void *ptr) {
+        static_cast<EnergyEstimator *>(ptr)->refresh();
+        return Config::ENERGY_CALC_REFRESH_MS;
+    }
+
+    static void onInputChanged(Event, void *ptr) {
+        static_cast<EnergyEstimator *>(ptr)->inputChanged();
+    }
+
+    void inputChanged() {
+        _inputsChanged = true;
+        if (_scheduler) _scheduler->runSoon(_task);
+    }
+
+    // Advance the AC state and the daily figures on every run; the power model only changes with
+    // the readings or the AC state, so it is recomputed only then
+    void refresh() {
+        ACPowerState previousState = _acState;
+        updateACState();
+
+        bool modelChanged = _inputsChanged || _acState != previousState;
+        if (modelChanged) {
+            _inputsChanged = false;
+            calculatePowerModel();
+            _recalculations++;
+        } else {
+            _skippedRecalculations++;
+        }
+
+        float lastDailyEnergy = _dailyEnergyKWh;
+        float lastDutyCycle = _currentDutyCycle;
+        trackDailyUsage();
+        updateDailyProjection();
+
+        if (_events && (modelChanged || _dailyEnergyKWh != lastDailyEnergy || _currentDutyCycle != lastDutyCycle)) {
+            _events->publish(Event::ENERGY_UPDATE);
+        }
+    }
+
     // Update AC state based on temperature control needs
     void updateACState() {
         if (!_sensors.isDataValid()) {
@@ -393,16 +545,16 @@ private:
                 // Auto turn on if total heat load exceeds threshold
                 if (totalHeatLoad > Config::AUTO_ON_HEAT_LOAD_THRESHOLD) {
                     _acState = ACPowerState::STARTING;
-                    _lastStateChange = millis();
+                    _lastStateChange = Clock::nowMs();
                 }
             }
             break;
 
         case ACPowerState::STARTING:
             // Transition from starting to running after startup period
-            if (millis() - _lastStateChange >= Config::AC_STARTUP_TIME_MS) {
+            if (Clock::hasElapsed(_lastStateChange, Config::AC_STARTUP_TIME_MS)) {
                 _acState = ACPowerState::RUNNING;
-                _lastStateChange = millis();
+                _lastStateChange = Clock::nowMs();
             }
             break;
 
@@ -410,7 +562,7 @@ private:
             // Switch to idle if target temperature is reached
             if (tempError <= Config::TEMP_DEADBAND) {
                 _acState = ACPowerState::IDLE;
-                _lastStateChange = millis();
+                _lastStateChange = Clock::nowMs();
             }
             break;
 
@@ -418,11 +570,11 @@ private:
             // Return to running if temperature drifts too far from target
             if (tempError > Config::TEMP_DEADBAND + Config::TEMP_DEADBAND_TOLERANCE) {
                 _acState = ACPowerState::RUNNING;
-                _lastStateChange = millis();
+                _lastStateChange = Clock::nowMs();
             }
             // Auto turn off if heat load is very low and AC has been running for minimum time
             else if (!isnan(_weather.getCurrentTemp()) && !isnan(_weather.getCurrentHumidity()) &&
-                     (millis() - _lastStateChange >= Config::AUTO_OFF_MIN_TIME_MS)) {
+                     Clock::hasElapsed(_lastStateChange, Config::AUTO_OFF_MIN_TIME_MS)) {
                 float outdoorTemp = _weather.getCurrentTemp();
                 float indoorHumidity = _sensors.getIndoorHumidity();
                 float outdoorHumidity = _weather.getCurrentHumidity();
@@ -435,9 +587,9 @@ private:
                 // Auto turn off if heat load is below lower threshold (hysteresis)
                 if (totalHeatLoad < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) {
                     // Add runtime to today's total before turning off
-                    _totalRuntimeToday += (millis() - _lastStateChange) / Config::MILLIS_TO_SECONDS;
+                    _totalRuntimeToday += Clock::elapsedMs(_lastStateChange) / Config::MILLIS_TO_SECONDS;
                     _acState = ACPowerState::OFF;
-                    _lastStateChange = millis();
+                    _lastStateChange = Clock::nowMs();
                 }
             }
             break;
@@ -446,29 +598,28 @@ private:
 
     void trackDailyUsage() {
         // Reset daily stats at midnight (24 hour period)
-        if (millis() - _lastDayReset >= Config::MILLISECONDS_PER_DAY) {
+        if (Clock::hasElapsed(_lastDayReset, Config::MILLISECONDS_PER_DAY)) {
             _totalRuntimeToday = 0;
             _dailyEnergyConsumed = 0.0;
-            _lastDayReset = millis();
+            _lastDayReset = Clock::nowMs();
         }
 
         // Add current energy consumption to daily total
         if (_acState != ACPowerState::OFF) {
-            float timeSinceLastCalc = (millis() - _lastCalculation) / Config::MILLIS_TO_SECONDS / Config::SECONDS_TO_HOURS; // hours
+            float timeSinceLastCalc = Clock::elapsedMs(_lastCalculation) / Config::MILLIS_TO_SECONDS / Config::SECONDS_TO_HOURS; // hours
             _dailyEnergyConsumed += _estimatedPowerWatts * timeSinceLastCalc / Config::WATTS_TO_KILOWATTS;                  // kWh
         }
+        _lastCalculation = Clock::nowMs(); // Integrated up to here
     }
 
-    void calculateEnergyUsage() {
-        _lastCalculation = millis();
-
+    // Heat load, COP and power draw from the current readings and AC state
+    void calculatePowerModel() {
         // Calculate power consumption based on current AC state
         if (_acState == ACPowerState::OFF) {
             _estimatedPowerWatts = 0.0;
             _currentCOP = 0.0;
             _heatLoadBTU = 0.0;
             _currentEER = 0.0;
-            _currentDutyCycle = 0.0;
         } else {
             // Only calculate if we have valid sensor data
             if (!_sensors.isDataValid()) {
@@ -523,10 +674,17 @@ private:
 
             // Calculate EER
             _currentEER = (_estimatedPowerWatts > 0) ? _heatLoadBTU / _estimatedPowerWatts : 0.0;
+        }
+    }
 
+    // Duty cycle and today's projection move with the clock and the energy integrated so far
+    void updateDailyProjection() {
+        if (_acState == ACPowerState::OFF) {
+            _currentDutyCycle = 0.0;
+        } else {
             // Calculate current duty cycle as percentage of day AC has been running
             float todayHours = getTodaysRuntimeHours();
-            float dayProgress = (millis() - _lastDayReset) / Config::MILLIS_TO_SECONDS / Config::SECONDS_TO_HOURS; // hours since day reset
+            float dayProgress = Clock::elapsedMs(_lastDayReset) / Config::MILLIS_TO_SECONDS / Config::SECONDS_TO_HOURS; // hours since day reset
             _currentDutyCycle = (dayProgress > 0) ? (todayHours / dayProgress) : 0.0;
             _currentDutyCycle = constrain(_currentDutyCycle, 0.0, 1.0);
         }
@@ -538,7 +696,7 @@ private:
             float avgPowerToday = (_dailyEnergyConsumed > 0 && todayProjectedHours > 0) ? (_dailyEnergyConsumed * Config::WATTS_TO_KILOWATTS / todayProjectedHours) : _estimatedPowerWatts;
 
             // Simple projection: assume similar usage pattern continues
-            float remainingHoursInDay = Config::HOURS_PER_DAY - ((millis() - _lastDayReset) / Config::MILLIS_TO_SECONDS / Config::SECONDS_TO_HOURS);
+            float remainingHoursInDay = Config::HOURS_PER_DAY - (Clock::elapsedMs(_lastDayReset) / Config::MILLIS_TO_SECONDS / Config::SECONDS_TO_HOURS);
             float projectedAdditionalHours = remainingHoursInDay * _currentDutyCycle;
 
             _dailyEnergyKWh = _dailyEnergyConsumed + (avgPowerToday * projectedAdditionalHours / Config::WATTS_TO_KILOWATTS);
@@ -552,26 +710,57 @@ private:
     }
 
     void updateEnergyDisplay() {
-        String stateStr = "";
-        switch (_acState) {
-        case ACPowerState::OFF:
-            stateStr = "OFF";
-            break;
-        case ACPowerState::STARTING:
-            stateStr = "STARTING";
-            break;
-        case ACPowerState::RUNNING:
-            stateStr = "RUNNING";
-            break;
-        case ACPowerState::IDLE:
-            stateStr = "IDLE";
-            break;
-        }
-
         // Update individual objects for new frontend
-        _disp.updateCurrentDraw(getCurrentDrawString());
-        _disp.updateDailyEstimate(getDailyEstimateString());
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printCurrentDraw(text);
+        _disp.updateCurrentDraw(text.c_str());
+        text.clear();
+        printDailyEstimate(text);
+        _disp.updateDailyEstimate(text.c_str());
         _disp.updateEnergyStatus(getEnergyStatusString());
+
+        if (_disp.isPageShown(Config::DISPLAY_PAGE_HEATLOAD)) {
+            updateHeatLoadDisplay();
+        }
+    }
+
+    static void renderHeatLoad(void *ptr) {
+        static_cast<EnergyEstimator *>(ptr)->updateHeatLoadDisplay();
+    }
+
+    // "<temp>°C, <humidity>%RH" and a line break
+    static void printReportConditions(Print &out, float temp, float humidity) {
+        out.print(temp, 1);
+        out.print("°C, ");
+        out.print((int)humidity);
+        out.println("%RH");
+    }
+
+    // "(Current: <first>W / <second>W)" and a blank line
+    static void printCurrentPair(Print &out, float first, float second) {
+        out.print("(Current: ");
+        out.print((int)first);
+        out.print("W / ");
+        out.print((int)second);
+        out.println("W)");
+        out.println();
+    }
+
+    // "<load>W (<percent>%)"
+    static void printLoadShare(Print &out, float load, float percent) {
+        out.print((int)load);
+        out.print("W (");
+        out.print((int)percent);
+        out.print("%)");
+    }
+
+    // "<label><temp>°C <humidity>%"
+    static void printConditions(Print &out, const char *label, float temp, float humidity) {
+        out.print(label);
+        out.print(temp, 1);
+        out.print("°C ");
+        out.print((int)humidity);
+        out.print('%');
     }
 
     // Calculate Coefficient of Performance (COP) based on conditions
@@ -619,17 +808,25 @@ private:
 
     // AC State tracking
     ACPowerState _acState;
-    uint32_t _lastStateChange = 0;
+    uint64_t _lastStateChange = 0;
     uint32_t _totalRuntimeToday = 0;  // Total runtime today in seconds
-    uint32_t _lastDayReset = 0;       // Last time daily stats were reset
+    uint64_t _lastDayReset = 0;       // Last time daily stats were reset
     float _dailyEnergyConsumed = 0.0; // Energy consumed today in kWh
 
     // Energy calculation variables
-    uint32_t _lastCalculation = 0;
+    uint64_t _lastCalculation = 0; // Daily energy integrated up to this time
     float _estimatedPowerWatts = 0.0;
     float _dailyEnergyKWh = 0.0;
     float _currentCOP = 0.0;
     float _heatLoadBTU = 0.0;
     float _currentEER = 0.0;
     float _currentDutyCycle = 0.0; // Kept for compatibility, but now calculated differently
+
+    // Event-driven recalculation
+    Scheduler *_scheduler = nullptr;
+    EventBus *_events = nullptr;
+    int8_t _task = -1;
+    bool _inputsChanged = true;
+    uint32_t _recalculations = 0;
+    uint32_t _skippedRecalculations = 0;
 };
@@ -0,0 +1,65 @@
+#pragma once
+#include "Config.h"
+
+// What changed. Subscribers read the new values from the publisher's getters.
+enum class Event : uint8_t {
+    INDOOR_SAMPLE,  // SensorHelper: DHT22 temperature or humidity changed, or became (in)valid
+    GAS_SAMPLE,     // SensorHelper: CO reading, ozone output or a warm-up state changed
+    OUTDOOR_SAMPLE, // WeatherHelper: NEA temperature or humidity changed
+    ENERGY_UPDATE,  // EnergyEstimator: power model or daily figures changed
+    COUNT
+};
+
+// In-process publish/subscribe between the helpers, so consumers recompute when their inputs
+// change instead of re-reading getters on a timer. Subscriber lists are fixed arrays filled in
+// begin(); handlers run inside publish() and should only note the change (e.g. mark themselves
+// dirty and call Scheduler::runSoon).
+class EventBus {
+public:
+    typedef void (*Handler)(Event event, void *ptr);
+
+    // Returns false if all EVENT_SUBSCRIBER_SLOTS of the event are taken
+    bool subscribe(Event event, Handler handler, void *ptr) {
+        uint8_t index = (uint8_t)event;
+        if (_counts[index] >= Config::EVENT_SUBSCRIBER_SLOTS) return false;
+        _subscribers[index][_counts[index]++] = {handler, ptr};
+        return true;
+    }
+
+    void publish(Event event) {
+        uint8_t index = (uint8_t)event;
+        _published[index]++;
+        for (uint8_t i = 0; i < _counts[index]; i++) {
+            _subscribers[index][i].handler(event, _subscribers[index][i].ptr);
+        }
+    }
+
+    uint32_t getPublished(Event event) const { return _published[(uint8_t)event]; }
+
+    static const char *getName(Event event) {
+        switch (event) {
+        case Event::INDOOR_SAMPLE:
+            return "indoor";
+        case Event::GAS_SAMPLE:
+            return "gas";
+        case Event::OUTDOOR_SAMPLE:
+            return "outdoor";
+        case Event::ENERGY_UPDATE:
+            return "energy";
+        default:
+            return "";
+        }
+    }
+
+private:
+    static constexpr uint8_t EVENT_COUNT = (uint8_t)Event::COUNT;
+
+    struct Subscriber {
+        Handler handler;
+        void *ptr;
+    };
+
+    Subscriber _subscribers[EVENT_COUNT][Config::EVENT_SUBSCRIBER_SLOTS] = {};
+    uint8_t _counts[EVENT_COUNT] = {};
+    uint32_t _published[EVENT_COUNT] = {};
+};
@@ -0,0 +1,41 @@
+#include "HeapStats.h"
+
+// The linker routes every malloc/calloc/realloc call, including those made by String and
+// operator new in the core, through these wrappers; __real_* are the original functions.
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+}
+
+namespace {
+    volatile uint32_t allocations = 0;
+    volatile uint32_t allocatedBytes = 0;
+
+    inline void count(size_t size) {
+        allocations++;
+        allocatedBytes += size;
+    }
+}
+
+extern "C" {
+void *__wrap_malloc(size_t size) {
+    count(size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count_, size_t size) {
+    count(count_ * size);
+    return __real_calloc(count_, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    if (size) count(size);
+    return __real_realloc(ptr, size);
+}
+}
+
+namespace HeapStats {
+    uint32_t getAllocations() { return allocations; }
+    uint32_t getAllocatedBytes() { return allocatedBytes; }
+}
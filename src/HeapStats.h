@@ -0,0 +1,9 @@
+#pragma once
+#include <Arduino.h>
+
+// Heap allocation counters, fed by the malloc/calloc/realloc wrappers in HeapStats.cpp
+// (hooked in with -Wl,--wrap in platformio.ini)
+namespace HeapStats {
+    uint32_t getAllocations();     // Calls that allocated since boot
+    uint32_t getAllocatedBytes();  // Bytes requested by those calls
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "Config.h"
+#include "Console.h"
+#include "DisplayManager.h"
+#include <ESP8266HTTPClient.h>
+#include <ESP8266WiFi.h>
+#include <WiFiClient.h>
+
+// PanelUpdater error messages
+namespace PanelUpdaterErrors {
+    constexpr char WIFI_NOT_CONNECTED[] = "Wi-Fi not connected";
+    constexpr char HTTP_REQUEST_FAILED[] = "HTTP request failed";
+    constexpr char UNKNOWN_SIZE[] = "Server sent no Content-Length";
+    constexpr char UPLOAD_FAILED[] = "Panel stopped acknowledging";
+}
+
+// Flashes a new HMI (.tft) onto the panel straight from an HTTP response: the body is passed on
+// as the panel acknowledges each 4 KB chunk, never stored on the MCU. The panel shows its own
+// progress bar during the transfer and the result, with the throughput, on the details page.
+class PanelUpdater {
+public:
+    explicit PanelUpdater(DisplayManager &disp) : _disp(disp) {}
+
+    void begin(Console &console) {
+        console.addCommand("panelUpdate", "Flash the HMI (.tft) from HTTP onto the panel [url]", onUpdateCommand, this);
+    }
+
+    // Blocks for the whole transfer, about a minute per 600 KB at 115200 baud. Without
+    // NEX_SERIAL_SWAP the console shares the panel's UART, so nothing may be printed meanwhile.
+    bool update(const char *url) {
+        _sent = 0;
+        _total = 0;
+        _elapsedMs = 0;
+
+        if (WiFi.status() != WL_CONNECTED) {
+            _lastError = PanelUpdaterErrors::WIFI_NOT_CONNECTED;
+            return false;
+        }
+
+        _httpClient.setTimeout(Config::HTTP_TIMEOUT_MS);
+        _httpClient.begin(_wifiClient, url);
+        int httpResponseCode = _httpClient.GET();
+        if (httpResponseCode != 200) {
+            _lastError = PanelUpdaterErrors::HTTP_REQUEST_FAILED + String(" (") + String(httpResponseCode) + ")";
+            _httpClient.end();
+            return false;
+        }
+
+        // whmi-wri needs the size up front, so chunked responses cannot be streamed
+        int size = _httpClient.getSize();
+        if (size <= 0) {
+            _lastError = PanelUpdaterErrors::UNKNOWN_SIZE;
+            _httpClient.end();
+            return false;
+        }
+        _total = size;
+
+        uint32_t start = millis();
+        bool ok = nexUploadTft(_httpClient.getStream(), _total, Config::PANEL_UPDATE_BAUD, onProgress, this);
+        _elapsedMs = millis() - start;
+        _httpClient.end();
+        _lastError = ok ? "" : PanelUpdaterErrors::UPLOAD_FAILED;
+
+        // A failed transfer leaves the panel waiting for the rest until it is power cycled
+        delay(Config::PANEL_UPDATE_REBOOT_MS);
+        _disp.reconnect();
+        _disp.showMain();
+        _disp.showPanelUpdateResult(ok, _sent, _total, getBytesPerSecond());
+        return ok;
+    }
+
+    uint32_t getBytesSent() const { return _sent; } // Acknowledged by the panel
+    uint32_t getTotalBytes() const { return _total; }
+    uint32_t getElapsedMs() const { return _elapsedMs; }
+    uint32_t getBytesPerSecond() const { return _elapsedMs ? (uint64_t)_sent * 1000 / _elapsedMs : 0; }
+    String getLastError() const { return _lastError; }
+
+private:
+    static void onUpdateCommand(Print &out, const char *args, void *ptr) {
+        PanelUpdater *self = static_cast<PanelUpdater *>(ptr);
+        bool ok = self->update(*args ? args : Config::PANEL_UPDATE_URL); // Blocks until the panel restarted
+
+        out.println("\n=== PANEL UPDATE ===");
+        out.print("Result: ");
+        out.println(ok ? "OK" : self->_lastError.c_str());
+        out.print("Sent: ");
+        out.print(self->_sent);
+        out.print(" of ");
+        out.print(self->_total);
+        out.print(" bytes in ");
+        out.print(self->_elapsedMs);
+        out.print(" ms (");
+        out.print(self->getBytesPerSecond());
+        out.println(" B/s)");
+    }
+
+    static void onProgress(uint32_t sent, uint32_t, void *ptr) {
+        static_cast<PanelUpdater *>(ptr)->_sent = sent;
+    }
+
+    HTTPClient _httpClient;
+    WiFiClient _wifiClient;
+    DisplayManager &_disp;
+
+    uint32_t _sent = 0;
+    uint32_t _total = 0;
+    uint32_t _elapsedMs = 0;
+    String _lastError = "";
+};
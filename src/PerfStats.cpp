@@ -0,0 +1,49 @@
+#include "PerfStats.h"
+
+namespace {
+    PerfStats::Probe probes[Config::PERF_PROBE_SLOTS];
+    uint8_t probeCount = 0;
+}
+
+namespace PerfStats {
+    Probe *add(const char *name) {
+        if (probeCount >= Config::PERF_PROBE_SLOTS) return nullptr;
+        Probe &probe = probes[probeCount++];
+        probe = {};
+        probe.name = name;
+        return &probe;
+    }
+
+    void record(Probe *probe, uint32_t startCycles) {
+        if (!probe) return;
+        uint32_t us = (ESP.getCycleCount() - startCycles) / ESP.getCpuFreqMHz();
+        uint8_t bucket = us ? 31 - __builtin_clz(us) : 0;
+        if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+
+        probe->buckets[bucket]++;
+        probe->count++;
+        if (us > probe->maxUs) probe->maxUs = us;
+    }
+
+    uint32_t percentileUs(const Probe &probe, uint8_t percent) {
+        if (!probe.count) return 0;
+        uint32_t rank = ((uint64_t)probe.count * percent + 99) / 100; // Samples at or below it
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS - 1; i++) {
+            seen += probe.buckets[i];
+            if (seen >= rank) return min((uint32_t)2 << i, probe.maxUs);
+        }
+        return probe.maxUs;
+    }
+
+    uint8_t getProbeCount() { return probeCount; }
+    const Probe &getProbe(uint8_t index) { return probes[index]; }
+
+    void reset() {
+        for (uint8_t i = 0; i < probeCount; i++) {
+            const char *name = probes[i].name;
+            probes[i] = {};
+            probes[i].name = name;
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "Config.h"
+
+// Latency histograms timed with the CPU cycle counter, one per probe: every scheduler task, the
+// polls loop() makes itself and the whole loop pass. Durations fall into log2 buckets of
+// microseconds, so percentiles are known to within a factor of two; the maximum is exact.
+// The cycle counter wraps after 2^32 cycles (53 s at 80 MHz, 26 s at 160 MHz).
+namespace PerfStats {
+    constexpr uint8_t BUCKETS = 24; // Bucket i holds [2^i, 2^(i+1)) us, the last one everything longer
+
+    struct Probe {
+        const char *name;
+        uint32_t count;
+        uint32_t maxUs;
+        uint32_t buckets[BUCKETS];
+    };
+
+    inline uint32_t start() { return ESP.getCycleCount(); }
+
+    Probe *add(const char *name);                    // nullptr once PERF_PROBE_SLOTS are taken
+    void record(Probe *probe, uint32_t startCycles); // Time since start(); ignores a null probe
+    uint32_t percentileUs(const Probe &probe, uint8_t percent); // Upper bound of its bucket
+    uint8_t getProbeCount();
+    const Probe &getProbe(uint8_t index);
+    void reset(); // Clear every histogram, keep the probes
+}
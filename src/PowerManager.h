@@ -0,0 +1,75 @@
+#pragma once
+#include "Clock.h"
+#include "Config.h"
+#include "DisplayManager.h"
+#include <ESP8266WiFi.h>
+extern "C" {
+#include <gpio.h>
+}
+
+// Offers the time between scheduler deadlines to the SDK to sleep through. The idle stretch is handed to the SDK in
+// one delay() of up to POWER_MAX_NAP_MS. In LIGHT_SLEEP mode the SDK suspends the radio and the
+// CPU through it between DTIM beacons whenever the station is connected. A low level on the
+// panel's UART RX (a touch event starting) or on the ozone sensor output wakes it early. No nap
+// is taken while a panel command awaits its reply, so the reply is not lost to a sleeping UART.
+// Forced light sleep (radio off) is not used: millis() stops during it and the scheduler would
+// lose time.
+//
+// What is measured is loop time, not sleep: the time spent in idle()'s delay() against the time
+// spent running tasks. Whether the SDK actually slept through a delay (it needs a connected
+// station and a quiet radio) is not visible here, so busy time is only a floor on awake time.
+class PowerManager {
+public:
+    explicit PowerManager(DisplayManager &disp) : _disp(disp) {}
+
+    void begin() {
+        switch (Config::POWER_MODE) {
+        case Config::PowerMode::ACTIVE:
+            WiFi.setSleepMode(WIFI_NONE_SLEEP);
+            break;
+        case Config::PowerMode::MODEM_SLEEP:
+            WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+            break;
+        case Config::PowerMode::LIGHT_SLEEP:
+            WiFi.setSleepMode(WIFI_LIGHT_SLEEP, Config::POWER_LISTEN_INTERVAL);
+            gpio_pin_wakeup_enable(GPIO_ID_PIN(UART_RX_PIN), GPIO_PIN_INTR_LOLEVEL);
+            gpio_pin_wakeup_enable(GPIO_ID_PIN(Config::MQ131_DIGITAL_PIN), GPIO_PIN_INTR_LOLEVEL); // Active low
+            break;
+        }
+        _windowStart = Clock::nowMs();
+    }
+
+    // Wait for the next deadline, dueMs away, or part of the way there
+    void idle(uint32_t dueMs) {
+        bool mayNap = Config::POWER_MODE != Config::PowerMode::ACTIVE && _disp.isLinkIdle();
+        uint32_t nap = min(dueMs, mayNap ? Config::POWER_MAX_NAP_MS : Config::SCHEDULER_IDLE_SLICE_MS);
+
+        uint32_t start = millis();
+        delay(nap);
+        _loopIdleMs += millis() - start;
+
+        uint32_t elapsed = Clock::elapsedMs(_windowStart);
+        if (elapsed >= Config::POWER_WINDOW_MS) {
+            _lastLoopBusyPermille = elapsed > _loopIdleMs ? (uint64_t)(elapsed - _loopIdleMs) * 1000 / elapsed : 0;
+            _windowStart = Clock::nowMs();
+            _loopIdleMs = 0;
+        }
+    }
+
+    // Share of the last POWER_WINDOW_MS the loop spent running rather than in idle(), in tenths of
+    // a percent
+    uint16_t getLoopBusyPermille() const { return _lastLoopBusyPermille; }
+    float getLoopBusyPercent() const { return _lastLoopBusyPermille / 10.0; }
+
+private:
+#ifdef NEX_SERIAL_SWAP
+    static constexpr uint8_t UART_RX_PIN = 13; // UART0 RX after Serial.swap()
+#else
+    static constexpr uint8_t UART_RX_PIN = 3;
+#endif
+
+    DisplayManager &_disp;
+    uint64_t _windowStart = 0;
+    uint32_t _loopIdleMs = 0; // In idle()'s delay() during the current window, asleep or not
+    uint16_t _lastLoopBusyPermille = 1000;
+};
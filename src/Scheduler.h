@@ -0,0 +1,146 @@
+#pragma once
+#include "Config.h"
+#include "HeapStats.h"
+#include "PerfStats.h"
+
+// Runs periodic tasks by deadline instead of having every poll() compare millis() against its own
+// interval. Deadlines sit in a binary min-heap: the next one is found in O(1) and a task is
+// rescheduled in O(log n). A task returns how long until it wants to run again, counted from the
+// deadline it was due at so lateness does not accumulate.
+class Scheduler {
+public:
+    typedef uint32_t (*TaskFn)(void *ptr); // Returns milliseconds until the next run
+
+    struct TaskStats {
+        const char *name;
+        uint32_t runs;
+        uint32_t missed;           // Deadlines skipped because the task ran a whole interval late
+        uint32_t totalLateMs;      // Time between deadlines and the runs they triggered
+        uint32_t maxLateMs;
+        PerfStats::Probe *runTime; // Histogram of the run durations, null if no probe was left
+        uint32_t allocations;      // Heap allocations made while running
+        bool mayAllocate;          // Network tasks; the others should never allocate
+    };
+
+    // Returns the task id, -1 if all SCHEDULER_TASK_SLOTS are taken
+    int8_t add(const char *name, TaskFn fn, void *ptr, uint32_t firstDelayMs = 0, bool mayAllocate = false) {
+        if (_count >= Config::SCHEDULER_TASK_SLOTS) return -1;
+
+        uint8_t id = _count++;
+        _tasks[id] = {fn, ptr, (uint32_t)(millis() + firstDelayMs)};
+        _stats[id] = {name, 0, 0, 0, 0, PerfStats::add(name), 0, mayAllocate};
+        _slot[id] = id;
+        _heap[id] = id;
+        siftUp(id);
+        return id;
+    }
+
+    // Run the task at the next runDue() instead of waiting for its deadline
+    void runSoon(int8_t id) {
+        if (id < 0 || id >= _count) return;
+        uint32_t now = millis();
+        if ((int32_t)(_tasks[id].deadline - now) <= 0) return;
+        _tasks[id].deadline = now;
+        siftUp(_slot[id]);
+    }
+
+    // Run every task whose deadline has passed, earliest deadline first
+    void runDue() {
+        uint32_t now = millis();
+        while (_count && (int32_t)(now - _tasks[_heap[0]].deadline) >= 0) {
+            uint8_t id = _heap[0];
+            Task &task = _tasks[id];
+            TaskStats &stats = _stats[id];
+
+            uint32_t late = millis() - task.deadline;
+            uint32_t allocationsBefore = HeapStats::getAllocations();
+            uint32_t startCycles = PerfStats::start();
+            uint32_t delay = task.fn(task.ptr);
+            PerfStats::record(stats.runTime, startCycles);
+
+            stats.runs++;
+            stats.totalLateMs += late;
+            if (late > stats.maxLateMs) stats.maxLateMs = late;
+            stats.allocations += HeapStats::getAllocations() - allocationsBefore;
+
+            uint32_t next = task.deadline + delay;
+            if (delay == 0) {
+                next = now + 1; // Again on the next pass, not in this one
+            } else if ((int32_t)(next - now) <= 0) {
+                // Fell a whole interval behind: skip to the next deadline in phase with the old ones
+                uint32_t skipped = (now - next) / delay + 1;
+                stats.missed += skipped;
+                next += skipped * delay;
+            }
+            task.deadline = next;
+            siftDown(0);
+        }
+    }
+
+    // 0 if a task is due, UINT32_MAX with no task registered
+    uint32_t msUntilNext() const {
+        if (!_count) return UINT32_MAX;
+        int32_t remaining = _tasks[_heap[0]].deadline - millis();
+        return remaining > 0 ? remaining : 0;
+    }
+
+    uint8_t getTaskCount() const { return _count; }
+    const TaskStats &getStats(uint8_t id) const { return _stats[id]; }
+    uint32_t getAverageLateMs(uint8_t id) const {
+        return _stats[id].runs ? _stats[id].totalLateMs / _stats[id].runs : 0;
+    }
+
+    // Allocations by tasks registered as not allocating (should stay at zero)
+    uint32_t getUnexpectedAllocations() const {
+        uint32_t allocations = 0;
+        for (uint8_t id = 0; id < _count; id++) {
+            if (!_stats[id].mayAllocate) allocations += _stats[id].allocations;
+        }
+        return allocations;
+    }
+
+private:
+    struct Task {
+        TaskFn fn;
+        void *ptr;
+        uint32_t deadline;
+    };
+
+    bool earlier(uint8_t a, uint8_t b) const {
+        return (int32_t)(_tasks[_heap[a]].deadline - _tasks[_heap[b]].deadline) < 0;
+    }
+
+    void swap(uint8_t a, uint8_t b) {
+        uint8_t id = _heap[a];
+        _heap[a] = _heap[b];
+        _heap[b] = id;
+        _slot[_heap[a]] = a;
+        _slot[_heap[b]] = b;
+    }
+
+    void siftUp(uint8_t pos) {
+        while (pos > 0 && earlier(pos, (pos - 1) / 2)) {
+            swap(pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+        }
+    }
+
+    void siftDown(uint8_t pos) {
+        while (true) {
+            uint8_t first = pos;
+            uint8_t left = 2 * pos + 1;
+            uint8_t right = left + 1;
+            if (left < _count && earlier(left, first)) first = left;
+            if (right < _count && earlier(right, first)) first = right;
+            if (first == pos) return;
+            swap(pos, first);
+            pos = first;
+        }
+    }
+
+    Task _tasks[Config::SCHEDULER_TASK_SLOTS] = {};
+    TaskStats _stats[Config::SCHEDULER_TASK_SLOTS] = {};
+    uint8_t _heap[Config::SCHEDULER_TASK_SLOTS] = {}; // Task ids, earliest deadline first
+    uint8_t _slot[Config::SCHEDULER_TASK_SLOTS] = {}; // Heap position of each task
+    uint8_t _count = 0;
+};
@@ -1,13 +1,20 @@
 #pragma once
+#include "Clock.h"
 #include "Config.h"
+#include "Dht22.h"
 #include "DisplayManager.h"
-#include <DHT.h>
+#include "EventBus.h"
+#include "Scheduler.h"
+#include "TextBuffer.h"
+#include "Tracer.h"
+#include "WarmState.h"
 
 class SensorHelper {
 public:
-    explicit SensorHelper(DisplayManager &disp) : _disp(disp), _dht(Config::DHT22_PIN, DHT22) {}
+    explicit SensorHelper(DisplayManager &disp) : _disp(disp), _dht(Config::DHT22_PIN) {}
 
-    void begin() {
+    void begin(Scheduler &scheduler, EventBus &events) {
+        _events = &events;
         _disp.showDhtInitializing();
         _dht.begin();
 
@@ -18,20 +25,31 @@ public:
         pinMode(Config::MQ131_DIGITAL_PIN, INPUT);
 
         // Record sensor start times for warmup periods (gas sensors only)
-        _coSensorStartTime = millis();
-        _ozoneSensorStartTime = millis();
+        _coSensorStartTime = Clock::nowMs();
+        _ozoneSensorStartTime = Clock::nowMs();
         _coSensorWarmedUp = false;
         _ozoneSensorWarmedUp = false;
 
-        // DHT22 doesn't need warmup time, just initial reading
-        readSensors();
-        _disp.showDhtInitialized();
+        // DHT22 doesn't need warmup time, just initial reading (on the first scheduler pass)
+        scheduler.add("sensors", onReadTask, this);
     }
 
-    void poll() {
-        if (millis() - _lastReading >= Config::SENSOR_REFRESH_MS) {
-            readSensors();
-        }
+    void saveState(WarmState &state) const {
+        state.indoorValid = _dataValid;
+        state.indoorTemp = _indoorTemp;
+        state.indoorHumidity = _indoorHumidity;
+        state.coWarmedUp = _coSensorWarmedUp;
+        state.ozoneWarmedUp = _ozoneSensorWarmedUp;
+    }
+
+    // After begin(): show the last readings until the sensors are read again
+    void restoreState(const WarmState &state) {
+        _dataValid = state.indoorValid;
+        _indoorTemp = state.indoorTemp;
+        _indoorHumidity = state.indoorHumidity;
+        _coSensorWarmedUp = state.coWarmedUp;
+        _ozoneSensorWarmedUp = state.ozoneWarmedUp;
+        updateDisplay();
     }
 
     // Getters for sensor values
@@ -50,7 +68,14 @@ public:
     bool isDataValid() const { return _dataValid; }
 
     // Get the last successful reading timestamp
-    uint32_t getLastReadingTime() const { return _lastValidReading; }
+    uint64_t getLastReadingTime() const { return _lastValidReading; }
+
+    // Milliseconds from boot to the first valid DHT22 reading, 0 until then
+    uint32_t getFirstReadingMs() const { return _firstReadingMs; }
+
+    // DHT22 frames that could not be decoded, and those that failed their checksum
+    uint32_t getDhtDecodeFailures() const { return _dht.getDecodeFailures(); }
+    uint32_t getDhtChecksumErrors() const { return _dht.getChecksumErrors(); }
 
     // Calculate temperature difference (indoor - outdoor)
     float getTempDifference(float outdoorTemp) const {
@@ -65,21 +90,49 @@ public:
     }
 
     // New methods for individual object updates
-    String getIndoorTempString() const {
+    void printIndoorTemp(Print &out) const {
+        out.print("Temperature: ");
         if (!_dataValid) {
-            return "Temperature: --.-°C";
+            out.print("--.-");
+        } else {
+            out.print(_indoorTemp, 1);
         }
-        return "Temperature: " + String(_indoorTemp, 1) + "°C";
+        out.print("°C");
     }
 
-    String getIndoorRhString() const {
+    void printIndoorRh(Print &out) const {
+        out.print("Relative Humidity: ");
         if (!_dataValid) {
-            return "Relative Humidity: --%";
+            out.print("--");
+        } else {
+            out.print((int)_indoorHumidity);
         }
-        return "Relative Humidity: " + String((int)_indoorHumidity) + "%";
+        out.print('%');
     }
 
-    String getIndoorStatusString() const {
+    void printCoValue(Print &out) const {
+        out.print("CO: ");
+        if (_coSensorWarmedUp) {
+            out.print((int)_coPPM);
+        } else {
+            out.print("---");
+        }
+        out.print(" ppm");
+    }
+
+    String getIndoorTempString() const {
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printIndoorTemp(text);
+        return text.c_str();
+    }
+
+    String getIndoorRhString() const {
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printIndoorRh(text);
+        return text.c_str();
+    }
+
+    const char *getIndoorStatusString() const {
         if (!_dataValid) {
             return "Status: Sensor Error";
         }
@@ -102,14 +155,12 @@ public:
     }
 
     String getCoValueString() const {
-        if (_coSensorWarmedUp) {
-            return "CO: " + String((int)_coPPM) + " ppm";
-        } else {
-            return "CO: --- ppm";
-        }
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printCoValue(text);
+        return text.c_str();
     }
 
-    String getCoStatusString() const {
+    const char *getCoStatusString() const {
         if (!_coSensorWarmedUp) {
             return "Status: Warming up";
         }
@@ -122,7 +173,7 @@ public:
         }
     }
 
-    String getOzoneStatusString() const {
+    const char *getOzoneStatusString() const {
         if (!_ozoneSensorWarmedUp) {
             return "Ozone Status: Warming up";
         }
@@ -139,20 +190,54 @@ public:
     }
 
 private:
-    void readSensors() {
-        _lastReading = millis();
+    static uint32_t onReadTask(void *ptr) {
+        SensorHelper *self = static_cast<SensorHelper *>(ptr);
+        uint32_t wait = self->pollDht();
+        if (wait) return wait; // Start signal or answer still in progress
+        self->readAndPublish();
+        // Until the DHT22 answers once, retry as soon as it can take another reading
+        return self->_firstReadingMs ? Config::SENSOR_REFRESH_MS : Config::DHT22_MIN_INTERVAL_MS;
+    }
+
+    uint32_t pollDht() {
+        Tracer::Span span("sensors.dht");
+        return _dht.poll();
+    }
+
+    // Publish INDOOR_SAMPLE / GAS_SAMPLE only for readings that differ from the previous ones
+    void readAndPublish() {
+        bool wasValid = _dataValid;
+        float lastTemp = _indoorTemp;
+        float lastHumidity = _indoorHumidity;
+        float lastCoPPM = _coPPM;
+        bool lastOzone = _ozoneDigitalReading;
+        bool lastCoWarmedUp = _coSensorWarmedUp;
+        bool lastOzoneWarmedUp = _ozoneSensorWarmedUp;
+
+        readSensors();
+
+        if (_dataValid != wasValid || (_dataValid && (_indoorTemp != lastTemp || _indoorHumidity != lastHumidity))) {
+            _events->publish(Event::INDOOR_SAMPLE);
+        }
+        if (_coPPM != lastCoPPM || _ozoneDigitalReading != lastOzone ||
+            _coSensorWarmedUp != lastCoWarmedUp || _ozoneSensorWarmedUp != lastOzoneWarmedUp) {
+            _events->publish(Event::GAS_SAMPLE);
+        }
+    }
 
+    void readSensors() {
+        Tracer::Span span("sensors.read");
         // Check if sensors have warmed up
-        if (!_coSensorWarmedUp && (millis() - _coSensorStartTime >= Config::MQ9_WARMUP_TIME_MS)) {
+        if (!_coSensorWarmedUp && Clock::hasElapsed(_coSensorStartTime, Config::MQ9_WARMUP_TIME_MS)) {
             _coSensorWarmedUp = true;
         }
-        if (!_ozoneSensorWarmedUp && (millis() - _ozoneSensorStartTime >= Config::MQ131_WARMUP_TIME_MS)) {
+        if (!_ozoneSensorWarmedUp && Clock::hasElapsed(_ozoneSensorStartTime, Config::MQ131_WARMUP_TIME_MS)) {
             _ozoneSensorWarmedUp = true;
         }
 
-        // Read temperature and humidity from DHT22
-        float temp = _dht.readTemperature();
-        float humidity = _dht.readHumidity();
+        // Temperature and humidity from the DHT22 frame just decoded
+        float temp = _dht.getTemperature();
+        float humidity = _dht.getHumidity();
 
         // Read CO sensor data
         _coAnalogReading = analogRead(Config::MQ9_ANALOG_PIN);
@@ -188,12 +273,7 @@ private:
 
             // Still update sensor displays even if DHT22 fails
             // Update individual objects for new frontend
-            _disp.updateIndoorTemp(getIndoorTempString());
-            _disp.updateIndoorRh(getIndoorRhString());
-            _disp.updateIndoorStatus(getIndoorStatusString());
-            _disp.updateCoValue(getCoValueString());
-            _disp.updateCoStatus(getCoStatusString());
-            _disp.updateOzoneStatus(getOzoneStatusString());
+            updateDisplay();
             return;
         }
 
@@ -202,16 +282,15 @@ private:
         _indoorHumidity = humidity;
         _dataValid = true;
         _failedReadings = 0;
-        _lastValidReading = millis();
+        _lastValidReading = Clock::nowMs();
+        if (!_firstReadingMs) {
+            _firstReadingMs = millis();
+            _disp.showDhtInitialized();
+        }
 
         // Update display with sensor data
         // Update individual objects for new frontend
-        _disp.updateIndoorTemp(getIndoorTempString());
-        _disp.updateIndoorRh(getIndoorRhString());
-        _disp.updateIndoorStatus(getIndoorStatusString());
-        _disp.updateCoValue(getCoValueString());
-        _disp.updateCoStatus(getCoStatusString());
-        _disp.updateOzoneStatus(getOzoneStatusString());
+        updateDisplay();
 
         // Update details page with raw CO sensor data
         _disp.updateCoDetails(_coVoltage, _coAnalogReading);
@@ -219,11 +298,28 @@ private:
         // DHT22 readings logged
     }
 
+    void updateDisplay() {
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+
+        printIndoorTemp(text);
+        _disp.updateIndoorTemp(text.c_str());
+        text.clear();
+        printIndoorRh(text);
+        _disp.updateIndoorRh(text.c_str());
+        _disp.updateIndoorStatus(getIndoorStatusString());
+        text.clear();
+        printCoValue(text);
+        _disp.updateCoValue(text.c_str());
+        _disp.updateCoStatus(getCoStatusString());
+        _disp.updateOzoneStatus(getOzoneStatusString());
+    }
+
     DisplayManager &_disp;
-    DHT _dht;
+    Dht22 _dht;
+    EventBus *_events = nullptr;
 
-    uint32_t _lastReading = 0;
-    uint32_t _lastValidReading = 0;
+    uint64_t _lastValidReading = 0;
+    uint32_t _firstReadingMs = 0;
 
     float _indoorTemp = 0.0;
     float _indoorHumidity = 0.0;
@@ -232,14 +328,14 @@ private:
     uint8_t _failedReadings = 0;
 
     // CO sensor variables
-    uint32_t _coSensorStartTime = 0;
+    uint64_t _coSensorStartTime = 0;
     bool _coSensorWarmedUp = false;
     uint16_t _coAnalogReading = 0;
     float _coVoltage = 0.0;
     float _coPPM = 0.0;
 
     // Ozone sensor variables
-    uint32_t _ozoneSensorStartTime = 0;
+    uint64_t _ozoneSensorStartTime = 0;
     bool _ozoneSensorWarmedUp = false;
     bool _ozoneDigitalReading = false;
 };
@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+
+// Print target backed by a fixed char array, for building display and console text without
+// touching the heap. Output past the capacity is dropped; the text stays null-terminated.
+template <size_t N>
+class TextBuffer : public Print {
+public:
+    TextBuffer() { clear(); }
+
+    size_t write(uint8_t c) override {
+        if (_len >= N - 1) {
+            _overflowed = true;
+            return 0;
+        }
+        _buf[_len++] = (char)c;
+        _buf[_len] = '\0';
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t size) override {
+        size_t written = 0;
+        while (written < size && write(data[written])) {
+            written++;
+        }
+        return written;
+    }
+    using Print::write;
+
+    void clear() {
+        _len = 0;
+        _buf[0] = '\0';
+        _overflowed = false;
+    }
+
+    const char *c_str() const { return _buf; }
+    size_t length() const { return _len; }
+    static constexpr size_t capacity() { return N - 1; }
+    bool overflowed() const { return _overflowed; }
+
+private:
+    char _buf[N];
+    size_t _len = 0;
+    bool _overflowed = false;
+};
@@ -1,8 +1,14 @@
 #pragma once
+#include "Clock.h"
 #include "Config.h"
 #include "DisplayManager.h"
 #include "EnergyEstimator.h"
+#include "EventBus.h"
+#include "PerfStats.h"
+#include "PowerManager.h"
+#include "Scheduler.h"
 #include "SensorHelper.h"
+#include "Tracer.h"
 #include "WeatherHelper.h"
 #include <ArduinoJson.h>
 #include <ESP8266HTTPClient.h>
@@ -20,42 +26,32 @@ namespace ThingsBoardErrors {
 class ThingsBoardHelper {
 public:
     explicit ThingsBoardHelper(DisplayManager &disp, SensorHelper &sensors,
-                               WeatherHelper &weather, EnergyEstimator &energy)
+                               WeatherHelper &weather, EnergyEstimator &energy, PowerManager &power)
         : _httpClient(), _disp(disp), _sensors(sensors),
-          _weather(weather), _energy(energy), _currentChunk(0), _lastChunkTime(0) {}
+          _weather(weather), _energy(energy), _power(power), _currentChunk(0) {}
 
-    void begin() {
+    void begin(Scheduler &scheduler, EventBus &events) {
         _httpClient.setTimeout(Config::HTTP_TIMEOUT_MS);
         _lastUpload = 0;
         _lastSuccessfulUpload = 0;
         _currentChunk = 0;
-        _lastChunkTime = 0;
-    }
+        scheduler.add("thingsboard", onUploadTask, this, 0, true); // HTTPClient/ArduinoJson allocate
 
-    void poll() {
-        if (Config::THINGSBOARD_USE_CHUNKED_UPLOAD) {
-            // Handle chunked uploads
-            if (_currentChunk == 0) {
-                // Start new upload cycle
-                if (millis() - _lastUpload >= Config::THINGSBOARD_UPLOAD_INTERVAL_MS) {
-                    uploadDataChunked();
-                }
-            } else {
-                // Continue with next chunk
-                if (millis() - _lastChunkTime >= Config::THINGSBOARD_CHUNK_DELAY_MS) {
-                    uploadDataChunked();
-                }
-            }
-        } else {
-            // Original single upload method
-            if (millis() - _lastUpload >= Config::THINGSBOARD_UPLOAD_INTERVAL_MS) {
-                uploadData();
-            }
-        }
+        // Chunks whose values did not change since the last cycle are left out of the next one
+        events.subscribe(Event::INDOOR_SAMPLE, onSample, this);
+        events.subscribe(Event::GAS_SAMPLE, onSample, this);
+        events.subscribe(Event::OUTDOOR_SAMPLE, onSample, this);
+        events.subscribe(Event::ENERGY_UPDATE, onEnergyUpdate, this);
     }
 
     // Get the last successful upload timestamp
-    uint32_t getLastUploadTime() const { return _lastSuccessfulUpload; }
+    uint64_t getLastUploadTime() const { return _lastSuccessfulUpload; }
+
+    // Milliseconds from boot to the first complete upload, 0 until then
+    uint32_t getFirstUploadMs() const { return _firstUploadMs; }
+
+    // Chunks left out of upload cycles because the server already had their values
+    uint32_t getSkippedChunks() const { return _skippedChunks; }
 
     // Get upload status
     bool isUploadSuccessful() const { return _lastUploadSuccessful; }
@@ -67,9 +63,66 @@ public:
     bool isConnected() { return WiFi.status() == WL_CONNECTED; }
 
 private:
-    void uploadDataChunked() {
-        _lastChunkTime = millis();
+    static constexpr uint8_t CHUNK_COUNT = 5;
+
+    static uint32_t onUploadTask(void *ptr) {
+        return static_cast<ThingsBoardHelper *>(ptr)->upload();
+    }
+
+    static void onSample(Event, void *ptr) {
+        static_cast<ThingsBoardHelper *>(ptr)->_freshReadings = true;
+    }
+
+    static void onEnergyUpdate(Event, void *ptr) {
+        static_cast<ThingsBoardHelper *>(ptr)->_freshEnergy = true;
+    }
+
+    // Returns the delay until the next call
+    uint32_t upload() {
+        if (WiFi.status() != WL_CONNECTED && !_lastSuccessfulUpload) {
+            return Config::NETWORK_WAIT_MS; // Still starting up: first upload as soon as Wi-Fi is up
+        }
+
+        if (!Config::THINGSBOARD_USE_CHUNKED_UPLOAD) {
+            uploadData(); // Original single upload method
+            return Config::THINGSBOARD_UPLOAD_INTERVAL_MS;
+        }
 
+        if (_currentChunk == 0) startCycle();
+        uploadDataChunked();
+        if (_currentChunk != 0 || !_lastUploadSuccessful) {
+            return Config::THINGSBOARD_CHUNK_DELAY_MS; // Next chunk, or a failed cycle starting over
+        }
+        return Config::THINGSBOARD_UPLOAD_INTERVAL_MS;
+    }
+
+    // Pick the chunks of this cycle. The status and performance chunks change with time and always
+    // go; the others only when an event changed them, or after a failed cycle.
+    void startCycle() {
+        bool resend = !_lastUploadSuccessful;
+        _cycleChunks = 1 << 3 | 1 << 4;
+        if (_freshReadings || resend) {
+            _cycleChunks |= 1 << 0 | 1 << 1;
+        } else {
+            _skippedChunks += 2;
+        }
+        if (_freshEnergy || resend) {
+            _cycleChunks |= 1 << 2;
+        } else {
+            _skippedChunks++;
+        }
+        _freshReadings = false; // Changes arriving from here on go into the next cycle
+        _freshEnergy = false;
+        _currentChunk = nextChunk(0);
+    }
+
+    // First chunk from `chunk` on that belongs to this cycle, CHUNK_COUNT past the last one
+    uint8_t nextChunk(uint8_t chunk) const {
+        while (chunk < CHUNK_COUNT && !(_cycleChunks & 1 << chunk)) chunk++;
+        return chunk;
+    }
+
+    void uploadDataChunked() {
         // Only upload if we have valid sensor data
         if (!_sensors.isDataValid()) {
             _lastError = ThingsBoardErrors::INVALID_SENSOR_DATA;
@@ -123,10 +176,20 @@ private:
 
         case 3: // System status chunk
             chunkName = "System Status";
-            doc["timestamp"] = millis();
+            doc["timestamp"] = Clock::nowMs();
             doc["sensor_last_reading"] = _sensors.getLastReadingTime();
             doc["chunk_sequence"] = _currentChunk;
             doc["upload_cycle"] = _lastUpload;
+            doc["first_reading_ms"] = _sensors.getFirstReadingMs();
+            doc["dht_decode_failures"] = _sensors.getDhtDecodeFailures();
+            doc["dht_checksum_errors"] = _sensors.getDhtChecksumErrors();
+            doc["first_upload_ms"] = _firstUploadMs;
+            doc["loop_busy_pct"] = _power.getLoopBusyPercent();
+            break;
+
+        case 4: // Loop and task latency chunk
+            chunkName = "Performance Data";
+            addPerfTelemetry(doc);
             break;
         }
 
@@ -138,26 +201,27 @@ private:
         bool success = sendHttpTelemetry(jsonString);
 
         if (success) {
-            _currentChunk++;
-            if (_currentChunk >= 4) {
+            _currentChunk = nextChunk(_currentChunk + 1);
+            if (_currentChunk >= CHUNK_COUNT) {
                 // All chunks sent successfully
                 _currentChunk = 0;
-                _lastUpload = millis();
-                _lastSuccessfulUpload = millis();
+                _lastUpload = Clock::nowMs();
+                _lastSuccessfulUpload = Clock::nowMs();
                 _lastUploadSuccessful = true;
                 _lastError = "";
+                if (!_firstUploadMs) _firstUploadMs = _lastSuccessfulUpload;
                 _disp.showThingsBoardSuccess();
             }
         } else {
             // Chunk failed, reset and try again next cycle
             _currentChunk = 0;
             _lastUploadSuccessful = false;
-            _disp.showThingsBoardError(_lastError);
+            _disp.showThingsBoardError(_lastError.c_str());
         }
     }
 
     void uploadData() {
-        _lastUpload = millis();
+        _lastUpload = Clock::nowMs();
 
         // Only upload if we have valid sensor data
         if (!_sensors.isDataValid()) {
@@ -208,8 +272,16 @@ private:
         doc["humidity_difference"] = _sensors.getHumidityDifference(_weather.getCurrentHumidity());
 
         // System status
-        doc["timestamp"] = millis();
+        doc["timestamp"] = Clock::nowMs();
         doc["sensor_last_reading"] = _sensors.getLastReadingTime();
+        doc["first_reading_ms"] = _sensors.getFirstReadingMs();
+        doc["dht_decode_failures"] = _sensors.getDhtDecodeFailures();
+        doc["dht_checksum_errors"] = _sensors.getDhtChecksumErrors();
+        doc["first_upload_ms"] = _firstUploadMs;
+        doc["loop_busy_pct"] = _power.getLoopBusyPercent();
+
+        // Loop and task latency
+        addPerfTelemetry(doc);
 
         // Convert to string
         String jsonString;
@@ -217,20 +289,33 @@ private:
 
         // Send via HTTP to ThingsBoard
         if (sendHttpTelemetry(jsonString)) {
-            _lastSuccessfulUpload = millis();
+            _lastSuccessfulUpload = Clock::nowMs();
             _lastUploadSuccessful = true;
             _lastError = "";
+            if (!_firstUploadMs) _firstUploadMs = _lastSuccessfulUpload;
 
             // Update display with upload success
             _disp.showThingsBoardSuccess();
         } else {
             _lastUploadSuccessful = false;
             // Error message is set in sendHttpTelemetry
-            _disp.showThingsBoardError(_lastError);
+            _disp.showThingsBoardError(_lastError.c_str());
+        }
+    }
+
+    // p50, p99 and max of every latency probe, as perf_<probe>_p50_us and so on
+    void addPerfTelemetry(JsonDocument &doc) {
+        for (uint8_t i = 0; i < PerfStats::getProbeCount(); i++) {
+            const PerfStats::Probe &probe = PerfStats::getProbe(i);
+            String key = String("perf_") + probe.name;
+            doc[key + "_p50_us"] = PerfStats::percentileUs(probe, 50);
+            doc[key + "_p99_us"] = PerfStats::percentileUs(probe, 99);
+            doc[key + "_max_us"] = probe.maxUs;
         }
     }
 
     bool sendHttpTelemetry(const String &jsonData) {
+        Tracer::Span span("thingsboard.send");
         // Use the complete URL from configuration
         String url = String(Config::THINGSBOARD_HTTP_URL);
 
@@ -262,13 +347,19 @@ private:
     SensorHelper &_sensors;
     WeatherHelper &_weather;
     EnergyEstimator &_energy;
+    PowerManager &_power;
 
-    uint32_t _lastUpload = 0;
-    uint32_t _lastSuccessfulUpload = 0;
+    uint64_t _lastUpload = 0;
+    uint64_t _lastSuccessfulUpload = 0;
+    uint32_t _firstUploadMs = 0;
     bool _lastUploadSuccessful = false;
     String _lastError = "";
 
     // Chunked upload state
     uint8_t _currentChunk = 0;
-    uint32_t _lastChunkTime = 0;
+
+    bool _freshReadings = true; // A reading changed since the current upload cycle started
+    bool _freshEnergy = true;   // So did the energy figures
+    uint8_t _cycleChunks = 0;   // Bit per chunk sent in the current cycle
+    uint32_t _skippedChunks = 0;
 };
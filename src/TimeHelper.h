@@ -1,33 +1,82 @@
 #pragma once
+#include "Clock.h"
 #include "Config.h"
 #include "DisplayManager.h"
+#include "Scheduler.h"
 #include <time.h>
 
 class TimeHelper {
 public:
     explicit TimeHelper(DisplayManager &disp) : _disp(disp) {}
 
-    void begin() {
+    // SNTP keeps retrying by itself until Wi-Fi is up; the clock task waits for the first answer
+    void begin(Scheduler &scheduler) {
         _disp.showTimeSyncing();
-
         configTime(Config::GMT_OFFSET_SEC, 0, Config::NTP_SERVER);
-        while (time(nullptr) < Config::NTP_MIN_EPOCH_TIME)
-            delay(Config::NTP_SYNC_DELAY_MS);
+        scheduler.add("clock", onClockTask, this);
+    }
+
+    bool isSynced() const { return _synced; }
+
+private:
+    static uint32_t onClockTask(void *ptr) {
+        TimeHelper *self = static_cast<TimeHelper *>(ptr);
+        if (!self->_synced && !self->checkSync()) {
+            return Config::NTP_SYNC_DELAY_MS;
+        }
+        self->tick();
+        return Config::CLOCK_REFRESH_MS;
+    }
+
+    bool checkSync() {
+        if (time(nullptr) < Config::NTP_MIN_EPOCH_TIME) return false;
 
+        _synced = true;
+        Clock::setEpoch(time(nullptr));
         _disp.showTimeSynced();
-        _lastClockUpdate = millis();
+        if (Config::CLOCK_USE_PANEL_RTC) {
+            syncPanelClock();
+        }
+        return true;
     }
 
-    void poll() {
-        if (millis() - _lastClockUpdate >= Config::CLOCK_REFRESH_MS) {
-            _lastClockUpdate = millis();
-            char buf[12]; // HH:MM:SS AM
-            formatTime(buf, sizeof(buf));
-            _disp.updateClock(buf);
+    void tick() {
+        if (Config::CLOCK_USE_PANEL_RTC && pollPanelClock()) {
+            return; // The panel renders the clock itself
         }
+
+        char buf[12]; // HH:MM:SS AM
+        formatTime(buf, sizeof(buf));
+        _disp.updateClock(buf);
+    }
+
+    // Returns true while the panel RTC keeps the clock, false while the MCU has to send it
+    bool pollPanelClock() {
+        switch (_disp.getPanelClock()) {
+        case DisplayManager::PanelClock::RUNNING:
+            _rtcConfirmed = true;
+            if (Clock::hasElapsed(_lastRtcSync, Config::CLOCK_RTC_RESYNC_MS)) {
+                syncPanelClock(); // Drift correction
+            }
+            return true;
+        case DisplayManager::PanelClock::SETTING:
+            return _rtcConfirmed; // A drift correction keeps the panel in charge
+        case DisplayManager::PanelClock::UNKNOWN:
+            if (Clock::hasElapsed(_lastRtcSync, Config::CLOCK_RTC_RETRY_MS)) {
+                syncPanelClock();
+            }
+            return false;
+        default:
+            return false; // No RTC on this model
+        }
+    }
+
+    void syncPanelClock() {
+        _lastRtcSync = Clock::nowMs();
+        time_t now = time(nullptr);
+        _disp.setPanelClock(*localtime(&now));
     }
 
-private:
     static void formatTime(char *out, size_t len) {
         time_t now = time(nullptr);
         struct tm *tm = localtime(&now);
@@ -45,5 +94,7 @@ private:
     }
 
     DisplayManager &_disp;
-    uint32_t _lastClockUpdate = 0;
+    uint64_t _lastRtcSync = 0;
+    bool _rtcConfirmed = false; // The panel accepted the RTC at least once
+    bool _synced = false;       // NTP answered at least once
 };
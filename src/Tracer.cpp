@@ -0,0 +1,55 @@
+#include "Tracer.h"
+
+namespace {
+    constexpr uint16_t SLOTS = Config::TRACE_SPANS ? Config::TRACE_SPANS : 1;
+
+    Tracer::Record records[SLOTS];
+    uint16_t next = 0;        // Slot the next record goes to
+    uint16_t recordCount = 0; // Up to TRACE_SPANS
+    uint32_t overwritten = 0; // Records lost to newer ones since the last clear
+}
+
+namespace Tracer {
+    bool recording = false;
+
+    void record(const char *name, uint32_t startCycles) {
+        uint32_t cycles = ESP.getCycleCount() - startCycles;
+        records[next] = {startCycles, cycles, (uint32_t)millis(), name};
+        next = (next + 1) % SLOTS;
+        if (recordCount < SLOTS) {
+            recordCount++;
+        } else {
+            overwritten++;
+        }
+    }
+
+    void setRecording(bool on) { recording = on && Config::TRACE_SPANS; }
+
+    void clear() {
+        next = 0;
+        recordCount = 0;
+        overwritten = 0;
+    }
+
+    void dump(Print &out) {
+        out.print("# trace cpu_mhz=");
+        out.print(ESP.getCpuFreqMHz());
+        out.print(" records=");
+        out.print(recordCount);
+        out.print(" overwritten=");
+        out.println(overwritten);
+
+        uint16_t first = (next + SLOTS - recordCount) % SLOTS;
+        for (uint16_t i = 0; i < recordCount; i++) {
+            const Record &r = records[(first + i) % SLOTS];
+            out.print(r.endMs);
+            out.print(' ');
+            out.print(r.startCycles);
+            out.print(' ');
+            out.print(r.cycles);
+            out.print(' ');
+            out.println(r.name);
+        }
+        out.println("# end");
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Config.h"
+
+// Timeline of what one loop pass spends its time on. A Span measures the scope it lives in with
+// the CPU cycle counter and, when it closes, leaves a 16-byte record in a ring of TRACE_SPANS
+// records; the oldest are overwritten. Recording is off until the `trace on` console command, and
+// an idle Span costs one flag test (none at all with TRACE_SPANS set to 0).
+// `trace` prints the ring, oldest first, for tools/trace_to_chrome.py to turn into a Chrome
+// trace_event file (chrome://tracing, ui.perfetto.dev).
+namespace Tracer {
+    struct Record {
+        uint32_t startCycles;
+        uint32_t cycles;
+        uint32_t endMs;   // millis() at the end, to place the cycle counter's 2^32 wraps
+        const char *name; // String literal, no spaces
+    };
+
+    extern bool recording;
+
+    void record(const char *name, uint32_t startCycles);
+    void setRecording(bool on);
+    void clear();
+    void dump(Print &out); // Header line, then "<endMs> <startCycles> <cycles> <name>" per record
+
+    // Records its own lifetime: declare one at the top of the scope to trace
+    class Span {
+    public:
+        explicit Span(const char *name) {
+            if (Config::TRACE_SPANS && recording) {
+                _name = name;
+                _startCycles = ESP.getCycleCount();
+            }
+        }
+        ~Span() {
+            if (_name) record(_name, _startCycles);
+        }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *_name = nullptr;
+        uint32_t _startCycles = 0;
+    };
+}
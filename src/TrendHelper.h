@@ -0,0 +1,169 @@
+#pragma once
+#include "Clock.h"
+#include "Config.h"
+#include "DisplayManager.h"
+#include "EnergyEstimator.h"
+#include "SensorHelper.h"
+#include "WeatherHelper.h"
+
+// Keeps a rolling history of the climate and power readings and draws it on the trends page
+// waveforms. Each waveform pixel stands for TREND_SAMPLES_PER_POINT samples, picked with
+// "largest triangle three buckets" (LTTB) so peaks survive the downsampling. The graphs are
+// filled in one addt transfer per channel when the page opens, then only new points are appended.
+class TrendHelper {
+public:
+    explicit TrendHelper(DisplayManager &disp, SensorHelper &sensors,
+                         WeatherHelper &weather, EnergyEstimator &energy)
+        : _disp(disp), _sensors(sensors), _weather(weather), _energy(energy) {}
+
+    void begin() {
+        _lastSample = Clock::nowMs();
+        _disp.onPageOpen(Config::DISPLAY_PAGE_TRENDS, onTrendsOpen, this);
+    }
+
+    void poll() {
+        if (Clock::hasElapsed(_lastSample, Config::TREND_SAMPLE_INTERVAL_MS)) {
+            _lastSample = Clock::nowMs();
+            recordSample();
+        }
+
+        if (_disp.getWaveformFailures() != _seenFailures) {
+            _seenFailures = _disp.getWaveformFailures();
+            redrawAll(); // A lost transfer leaves gaps, start over
+        }
+
+        streamNext();
+    }
+
+private:
+    static constexpr uint16_t POINTS = Config::TREND_WAVEFORM_WIDTH;
+    static constexpr uint8_t SPP = Config::TREND_SAMPLES_PER_POINT;
+    static constexpr uint16_t HISTORY = POINTS * SPP;
+    static constexpr uint8_t SERIES_COUNT = 5;
+
+    struct Series {
+        DisplayManager::Waveform waveform;
+        uint8_t channel;
+        float min; // Value drawn at the bottom of the waveform
+        float max; // Value drawn at the top
+        uint8_t samples[HISTORY]; // Ring buffer of values already scaled to the waveform's 0-255
+        uint32_t drawnPoints;     // Points (absolute, since boot) already on the panel
+        bool redraw;              // Clear the channel and send the whole history
+        uint32_t lastX;           // Sample index (since boot) of the last point drawn
+        uint8_t lastY;            // and its value
+    };
+
+    static void onTrendsOpen(void *ptr) {
+        static_cast<TrendHelper *>(ptr)->redrawAll(); // Waveform contents do not survive a page change
+    }
+
+    void redrawAll() {
+        for (Series &series : _series) {
+            series.redraw = true;
+        }
+    }
+
+    void recordSample() {
+        const float values[SERIES_COUNT] = {
+            _sensors.getIndoorTemp(), _weather.getCurrentTemp(),
+            _sensors.getIndoorHumidity(), _weather.getCurrentHumidity(),
+            _energy.getEstimatedPowerWatts()};
+
+        uint16_t slot = _totalSamples % HISTORY;
+        for (uint8_t i = 0; i < SERIES_COUNT; i++) {
+            Series &series = _series[i];
+            if (isnan(values[i])) {
+                // Hold the previous level rather than dropping to the bottom of the graph
+                series.samples[slot] = _totalSamples ? series.samples[(_totalSamples - 1) % HISTORY] : 0;
+            } else {
+                float scaled = (values[i] - series.min) * 255.0 / (series.max - series.min);
+                series.samples[slot] = (uint8_t)constrain(scaled, 0.0, 255.0);
+            }
+        }
+        _totalSamples++;
+    }
+
+    // One transfer per call at most, whenever the display scheduler has room for it
+    void streamNext() {
+        uint32_t completePoints = _totalSamples / SPP;
+        uint32_t oldestPoint = (_totalSamples > HISTORY ? _totalSamples - HISTORY + SPP - 1 : 0) / SPP;
+
+        for (Series &series : _series) {
+            uint32_t first = series.redraw ? oldestPoint : max(series.drawnPoints, oldestPoint);
+            if (first >= completePoints) {
+                if (series.redraw && _disp.canStreamWaveform(0)) {
+                    _disp.clearWaveform(series.waveform, series.channel);
+                    series.redraw = false;
+                    series.drawnPoints = completePoints;
+                }
+                continue;
+            }
+
+            uint16_t count = completePoints - first;
+            if (!_disp.canStreamWaveform(count)) return; // Keep the order, retry next tick
+
+            if (series.redraw) {
+                _disp.clearWaveform(series.waveform, series.channel);
+                series.lastX = first * SPP; // Anchor the first triangle on the oldest sample
+                series.lastY = series.samples[series.lastX % HISTORY];
+            }
+            for (uint16_t i = 0; i < count; i++) {
+                _out[i] = selectPoint(series, first + i);
+            }
+            _disp.streamWaveform(series.waveform, series.channel, _out, count);
+            series.redraw = false;
+            series.drawnPoints = completePoints;
+            return;
+        }
+    }
+
+    // LTTB: from the samples of the point's bucket, pick the one forming the largest triangle with
+    // the previously drawn point and the average of the next bucket. The newest bucket has no
+    // successor yet, so its own last sample stands in.
+    uint8_t selectPoint(Series &series, uint32_t point) {
+        uint32_t start = point * SPP;
+        float prevX = series.lastX;
+        float prevY = series.lastY;
+        float nextX, nextY = 0;
+
+        if ((point + 2) * SPP <= _totalSamples) {
+            for (uint8_t i = 0; i < SPP; i++) {
+                nextY += series.samples[(start + SPP + i) % HISTORY];
+            }
+            nextY /= SPP;
+            nextX = start + SPP + (SPP - 1) / 2.0;
+        } else {
+            nextY = series.samples[(start + SPP - 1) % HISTORY];
+            nextX = start + SPP - 1;
+        }
+
+        float bestArea = -1;
+        for (uint8_t i = 0; i < SPP; i++) {
+            uint8_t y = series.samples[(start + i) % HISTORY];
+            float area = fabs((prevX - nextX) * (y - prevY) - (prevX - (start + i)) * (nextY - prevY));
+            if (area > bestArea) {
+                bestArea = area;
+                series.lastX = start + i;
+                series.lastY = y;
+            }
+        }
+        return series.lastY;
+    }
+
+    DisplayManager &_disp;
+    SensorHelper &_sensors;
+    WeatherHelper &_weather;
+    EnergyEstimator &_energy;
+
+    Series _series[SERIES_COUNT] = {
+        {DisplayManager::Waveform::CLIMATE, 0, Config::TREND_TEMP_MIN, Config::TREND_TEMP_MAX, {}, 0, true, 0, 0},
+        {DisplayManager::Waveform::CLIMATE, 1, Config::TREND_TEMP_MIN, Config::TREND_TEMP_MAX, {}, 0, true, 0, 0},
+        {DisplayManager::Waveform::CLIMATE, 2, Config::TREND_HUMIDITY_MIN, Config::TREND_HUMIDITY_MAX, {}, 0, true, 0, 0},
+        {DisplayManager::Waveform::CLIMATE, 3, Config::TREND_HUMIDITY_MIN, Config::TREND_HUMIDITY_MAX, {}, 0, true, 0, 0},
+        {DisplayManager::Waveform::POWER, 0, 0.0, Config::AC_MAX_POWER_WATTS, {}, 0, true, 0, 0},
+    };
+    uint8_t _out[POINTS]; // Points of the transfer in flight
+    uint32_t _totalSamples = 0;
+    uint32_t _seenFailures = 0;
+    uint64_t _lastSample = 0;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include "Config.h"
+#include "EnergyEstimator.h"
+#include "Scheduler.h"
+#include "SensorHelper.h"
+#include "WarmState.h"
+#include "WeatherHelper.h"
+#include "WiFiHelper.h"
+
+// Snapshots the state worth keeping into RTC user memory every WARM_START_SNAPSHOT_MS. RTC memory
+// survives watchdog, exception and software resets (not power loss), so after one of those the
+// display and the energy estimator resume from the snapshot instead of starting from nothing.
+// A magic number and a CRC-32 reject power-on garbage and snapshots of an older layout.
+class WarmStart {
+public:
+    explicit WarmStart(SensorHelper &sensors, WeatherHelper &weather, EnergyEstimator &energy, WiFiHelper &wifi)
+        : _sensors(sensors), _weather(weather), _energy(energy), _wifi(wifi) {}
+
+    // Call after the components' begin(), before the first loop pass. Returns true if a
+    // snapshot was found and applied.
+    bool restore() {
+        WarmState state;
+        if (!ESP.rtcUserMemoryRead(Config::WARM_START_RTC_OFFSET, (uint32_t *)&state, sizeof(state))) return false;
+        if (state.magic != Config::WARM_START_MAGIC || state.crc != checksum(state)) return false;
+
+        _energy.restoreState(state);
+        _sensors.restoreState(state);
+        _weather.restoreState(state);
+        _wifi.restoreState(state);
+        _restored = true;
+        return true;
+    }
+
+    void begin(Scheduler &scheduler) {
+        scheduler.add("snapshot", onSnapshotTask, this, Config::WARM_START_SNAPSHOT_MS);
+    }
+
+    bool isRestored() const { return _restored; }
+    uint32_t getSnapshots() const { return _snapshots; }
+
+private:
+    static uint32_t onSnapshotTask(void *ptr) {
+        static_cast<WarmStart *>(ptr)->save();
+        return Config::WARM_START_SNAPSHOT_MS;
+    }
+
+    void save() {
+        WarmState state = {};
+        state.magic = Config::WARM_START_MAGIC;
+        _energy.saveState(state);
+        _sensors.saveState(state);
+        _weather.saveState(state);
+        _wifi.saveState(state);
+        state.crc = checksum(state);
+        if (ESP.rtcUserMemoryWrite(Config::WARM_START_RTC_OFFSET, (uint32_t *)&state, sizeof(state))) {
+            _snapshots++;
+        }
+    }
+
+    // CRC-32 (IEEE 802.3, bitwise: the snapshot is small and written rarely)
+    static uint32_t checksum(const WarmState &state) {
+        const uint8_t *data = (const uint8_t *)&state + offsetof(WarmState, crc) + sizeof(state.crc);
+        size_t length = sizeof(state) - offsetof(WarmState, crc) - sizeof(state.crc);
+        uint32_t crc = 0xFFFFFFFF;
+        while (length--) {
+            crc ^= *data++;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+            }
+        }
+        return ~crc;
+    }
+
+    SensorHelper &_sensors;
+    WeatherHelper &_weather;
+    EnergyEstimator &_energy;
+    WiFiHelper &_wifi;
+    bool _restored = false;
+    uint32_t _snapshots = 0;
+};
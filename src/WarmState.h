@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+
+// What survives a watchdog or crash reset in RTC user memory (see WarmStart). Timestamps are kept
+// as ages because millis() starts over after the reset. Sized in whole 4-byte RTC blocks.
+struct WarmState {
+    uint32_t magic; // Config::WARM_START_MAGIC, changed whenever this layout changes
+    uint32_t crc;   // CRC-32 of everything after this field
+
+    // EnergyEstimator
+    uint32_t runtimeTodaySec;
+    uint32_t dayAgeMs;   // Since the daily totals were last reset
+    uint32_t stateAgeMs; // Since the AC state last changed
+    float energyTodayKWh;
+    uint8_t acState;
+
+    // SensorHelper
+    bool indoorValid;
+    bool coWarmedUp; // The gas sensor heaters stay powered through an MCU reset
+    bool ozoneWarmedUp;
+    float indoorTemp;
+    float indoorHumidity;
+
+    // WeatherHelper
+    float outdoorTemp; // NAN while unknown
+    float outdoorHumidity;
+    char stationId[8]; // Nearest NEA station, empty while unknown
+
+    // WiFiHelper: join the last access point directly instead of scanning every channel
+    uint8_t bssid[6];
+    uint8_t channel; // 0 while unknown
+    uint8_t reserved;
+};
+
+static_assert(sizeof(WarmState) % 4 == 0, "RTC user memory is written in 4-byte blocks");
@@ -1,6 +1,11 @@
 #pragma once
 #include "Config.h"
 #include "DisplayManager.h"
+#include "EventBus.h"
+#include "Scheduler.h"
+#include "TextBuffer.h"
+#include "Tracer.h"
+#include "WarmState.h"
 #include <ArduinoJson.h>
 #include <ESP8266HTTPClient.h>
 #include <ESP8266WiFi.h>
@@ -19,39 +24,75 @@ class WeatherHelper {
 public:
     explicit WeatherHelper(DisplayManager &disp) : _disp(disp) {}
 
-    void begin() {
+    void begin(Scheduler &scheduler, EventBus &events) {
+        _events = &events;
         _disp.showLocation(Config::LATITUDE, Config::LONGITUDE);
-        fetch();
+        scheduler.add("weather", onFetchTask, this, 0, true); // HTTPClient/ArduinoJson allocate
     }
 
-    void poll() {
-        if (millis() - _lastFetch >= Config::WEATHER_REFRESH_MS)
-            fetch();
+    void saveState(WarmState &state) const {
+        state.outdoorTemp = _currentTemp;
+        state.outdoorHumidity = _currentHumidity;
+        strncpy(state.stationId, _closestStationId.c_str(), sizeof(state.stationId)); // Unterminated if it fills the field
+    }
+
+    // After begin(): show the last readings until the next fetch
+    void restoreState(const WarmState &state) {
+        _currentTemp = state.outdoorTemp;
+        _currentHumidity = state.outdoorHumidity;
+        char stationId[sizeof(state.stationId) + 1] = {};
+        memcpy(stationId, state.stationId, sizeof(state.stationId));
+        _closestStationId = stationId;
+        updateDisplay();
     }
 
     float getCurrentTemp() const { return _currentTemp; }
     float getCurrentHumidity() const { return _currentHumidity; }
 
     // New methods for individual object updates
-    String getOutdoorTempString() const {
+    void printOutdoorTemp(Print &out) const {
+        out.print("Temperature: ");
         if (!isnan(_currentTemp)) {
-            return "Temperature: " + String(_currentTemp, 1) + "°C";
+            out.print(_currentTemp, 1);
         } else {
-            return "Temperature: --.-°C";
+            out.print("--.-");
         }
+        out.print("°C");
     }
 
-    String getOutdoorRhString() const {
+    void printOutdoorRh(Print &out) const {
+        out.print("Relative Humidity: ");
         if (!isnan(_currentHumidity)) {
-            return "Relative Humidity: " + String((int)_currentHumidity) + "%";
+            out.print((int)_currentHumidity);
         } else {
-            return "Relative Humidity: --%";
+            out.print("--");
         }
+        out.print('%');
+    }
+
+    String getOutdoorTempString() const {
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printOutdoorTemp(text);
+        return text.c_str();
+    }
+
+    String getOutdoorRhString() const {
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printOutdoorRh(text);
+        return text.c_str();
     }
 
 private:
+    static uint32_t onFetchTask(void *ptr) {
+        if (WiFi.status() != WL_CONNECTED) return Config::NETWORK_WAIT_MS; // First fetch as soon as it is up
+        static_cast<WeatherHelper *>(ptr)->fetch();
+        return Config::WEATHER_REFRESH_MS;
+    }
+
     void fetch() {
-        _lastFetch = millis();
+        Tracer::Span span("weather.fetch");
+        float lastTemp = _currentTemp;
+        float lastHumidity = _currentHumidity;
 
         // Fetch temperature data to get station list and find closest station
         if (fetchTemperature()) {
@@ -64,8 +105,15 @@ private:
             // If temperature fetch fails, set fallback display
             updateDisplay();
         }
+
+        if (!sameReading(_currentTemp, lastTemp) || !sameReading(_currentHumidity, lastHumidity)) {
+            _events->publish(Event::OUTDOOR_SAMPLE);
+        }
     }
 
+    // Equal, or both unknown
+    static bool sameReading(float a, float b) { return a == b || (isnan(a) && isnan(b)); }
+
     double calculateDistance(double lat1, double lon1, double lat2, double lon2) {
         // Haversine formula for calculating distance between two points on Earth
         const double dlat = (lat2 - lat1) * M_PI / 180.0;
@@ -137,6 +185,17 @@ private:
         return NAN;
     }
 
+    // TLS handshake, request and response headers
+    static int get(HTTPClient &http) {
+        Tracer::Span span("weather.get");
+        return http.GET();
+    }
+
+    static DeserializationError parse(JsonDocument &doc, const String &payload) {
+        Tracer::Span span("weather.parse");
+        return deserializeJson(doc, payload);
+    }
+
     bool fetchTemperature() {
         WiFiClientSecure secureClient;
         secureClient.setInsecure(); // Skip certificate validation for simplicity
@@ -149,14 +208,14 @@ private:
         http.addHeader("Accept", "application/json");
         http.setTimeout(Config::HTTP_TIMEOUT_MS); // HTTP timeout for HTTPS
 
-        int httpCode = http.GET();
+        int httpCode = get(http);
 
         if (httpCode == HTTP_CODE_OK) {
             String payload = http.getString();
             http.end();
 
             DynamicJsonDocument doc(Config::JSON_DOC_SIZE);
-            DeserializationError error = deserializeJson(doc, payload);
+            DeserializationError error = parse(doc, payload);
 
             if (!error && doc["code"] == 0) {
                 JsonArray stations = doc["data"]["stations"];
@@ -188,14 +247,14 @@ private:
         http.addHeader("Accept", "application/json");
         http.setTimeout(Config::HTTP_TIMEOUT_MS);
 
-        int httpCode = http.GET();
+        int httpCode = get(http);
 
         if (httpCode == HTTP_CODE_OK) {
             String payload = http.getString();
             http.end();
 
             DynamicJsonDocument doc(Config::JSON_DOC_SIZE);
-            DeserializationError error = deserializeJson(doc, payload);
+            DeserializationError error = parse(doc, payload);
 
             if (!error && doc["code"] == 0) {
                 JsonArray readings = doc["data"]["readings"];
@@ -210,12 +269,16 @@ private:
 
     void updateDisplay() {
         // Update individual objects for new frontend
-        _disp.updateOutdoorTemp(getOutdoorTempString());
-        _disp.updateOutdoorRh(getOutdoorRhString());
+        TextBuffer<Config::DISPLAY_TEXT_BUFFER_SIZE> text;
+        printOutdoorTemp(text);
+        _disp.updateOutdoorTemp(text.c_str());
+        text.clear();
+        printOutdoorRh(text);
+        _disp.updateOutdoorRh(text.c_str());
     }
 
     DisplayManager &_disp;
-    uint32_t _lastFetch = 0;
+    EventBus *_events = nullptr;
     float _currentTemp = NAN;
     float _currentHumidity = NAN;
     String _closestStationId = "";
@@ -1,62 +1,101 @@
 #pragma once
+#include "Clock.h"
 #include "Config.h"
 #include "DisplayManager.h"
+#include "Scheduler.h"
+#include "WarmState.h"
 #include <ESP8266WiFi.h>
 
+// Connects in the background: a scheduler task starts an attempt, checks on it every
+// WIFI_CONNECT_DELAY_MS and gives up after WIFI_TIMEOUT_MS, so sensors, alerts and the display
+// keep running while the network is down. Network tasks check isConnected() themselves.
 class WiFiHelper {
 public:
     explicit WiFiHelper(DisplayManager &disp) : _disp(disp) {}
 
-    void begin() {
+    void begin(Scheduler &scheduler) {
+        WiFi.mode(WIFI_STA);
         _retryCount = 1;
-        connect();
+        _state = State::IDLE;
+        scheduler.add("wifi", onConnectTask, this);
     }
 
-    bool poll() {
-        if (WiFi.status() != WL_CONNECTED) {
-            if (_everConnected) {
-                _everConnected = false;
-                _disp.begin();
-                _retryCount = 1;
-                connect();
-            } else if (!_connecting && millis() - _lastAttempt >= Config::WIFI_RETRY_DELAY_MS) {
-                connect();
-            }
-            return false;
-        }
-        if (!_everConnected) {
-            _everConnected = true;
-            _retryCount = 1;
-            return true;
-        }
-        return false;
+    bool isConnected() const { return _state == State::CONNECTED; }
+
+    void saveState(WarmState &state) const {
+        state.channel = 0;
+        if (_state != State::CONNECTED) return;
+        memcpy(state.bssid, WiFi.BSSID(), sizeof(state.bssid));
+        state.channel = WiFi.channel();
+    }
+
+    // Before the first attempt: join the access point used before the reset
+    void restoreState(const WarmState &state) {
+        memcpy(_bssid, state.bssid, sizeof(_bssid));
+        _channel = state.channel;
     }
 
+    // Milliseconds from boot to the first connection, 0 until then
+    uint32_t getFirstConnectMs() const { return _firstConnectMs; }
+
 private:
-    void connect() {
-        _connecting = true;
-        _lastAttempt = millis();
-        _disp.showWifiConnecting(_retryCount);
+    enum class State : uint8_t {
+        IDLE,       // Waiting to start the next attempt
+        CONNECTING, // WiFi.begin() issued, waiting for the association
+        CONNECTED
+    };
 
-        WiFi.mode(WIFI_STA);
-        WiFi.begin(Config::SSID, Config::PASSWORD);
+    static uint32_t onConnectTask(void *ptr) {
+        return static_cast<WiFiHelper *>(ptr)->step();
+    }
 
-        const uint32_t t0 = millis();
-        while (WiFi.status() != WL_CONNECTED && millis() - t0 < Config::WIFI_TIMEOUT_MS) {
-            delay(Config::WIFI_CONNECT_DELAY_MS);
-        }
-        _connecting = false;
+    // Returns the delay until the next step
+    uint32_t step() {
+        bool connected = WiFi.status() == WL_CONNECTED;
 
-        if (WiFi.status() == WL_CONNECTED) {
-            _disp.showWifiConnected(WiFi.SSID().c_str(), WiFi.localIP());
-        } else {
+        switch (_state) {
+        case State::IDLE:
+            _attemptStart = Clock::nowMs();
+            _disp.showWifiConnecting(_retryCount);
+            if (_channel) {
+                WiFi.begin(Config::SSID, Config::PASSWORD, _channel, _bssid);
+                _channel = 0; // Scan again if that access point does not answer
+            } else {
+                WiFi.begin(Config::SSID, Config::PASSWORD);
+            }
+            _state = State::CONNECTING;
+            return Config::WIFI_CONNECT_DELAY_MS;
+
+        case State::CONNECTING:
+            if (connected) {
+                _state = State::CONNECTED;
+                _retryCount = 1;
+                if (!_firstConnectMs) _firstConnectMs = millis();
+                _disp.showWifiConnected(WiFi.SSID().c_str(), WiFi.localIP());
+                return Config::NETWORK_WAIT_MS;
+            }
+            if (!Clock::hasElapsed(_attemptStart, Config::WIFI_TIMEOUT_MS)) {
+                return Config::WIFI_CONNECT_DELAY_MS;
+            }
             ++_retryCount;
+            _state = State::IDLE;
+            return Config::WIFI_RETRY_DELAY_MS;
+
+        case State::CONNECTED:
+        default:
+            if (!connected) {
+                _state = State::IDLE; // Lost it: reconnect without leaving the page on screen
+                return 0;
+            }
+            return Config::NETWORK_WAIT_MS;
         }
     }
 
     DisplayManager &_disp;
-    bool _everConnected = false;
-    bool _connecting = false;
+    State _state = State::IDLE;
     uint16_t _retryCount = 1;
-    uint32_t _lastAttempt = 0;
+    uint64_t _attemptStart = 0;
+    uint32_t _firstConnectMs = 0;
+    uint8_t _bssid[6] = {};
+    uint8_t _channel = 0; // Known access point channel, 0 to scan
 };
@@ -1,240 +1,467 @@
 #include "AlertManager.h"
+#include "Clock.h"
 #include "Config.h"
+#include "Console.h"
 #include "DisplayManager.h"
 #include "EnergyEstimator.h"
+#include "EventBus.h"
+#include "HeapStats.h"
+#include "PanelUpdater.h"
+#include "PerfStats.h"
+#include "PowerManager.h"
+#include "Scheduler.h"
 #include "SensorHelper.h"
 #include "ThingsBoardHelper.h"
 #include "TimeHelper.h"
+#include "Tracer.h"
+#include "TrendHelper.h"
+#include "WarmStart.h"
 #include "WeatherHelper.h"
 #include "WiFiHelper.h"
 #include <NexTouch.h>
 
 /* ---------- Singletons ---------- */
+Console console;
+Scheduler scheduler;
+EventBus events;
 DisplayManager display;
 WiFiHelper wifi(display);
 TimeHelper timeManager(display);
 WeatherHelper weather(display);
 SensorHelper sensors(display);
 EnergyEstimator energyEstimator(display, sensors, weather);
-ThingsBoardHelper thingsBoard(display, sensors, weather, energyEstimator);
+PowerManager power(display);
+ThingsBoardHelper thingsBoard(display, sensors, weather, energyEstimator, power);
 AlertManager alertManager(display, sensors, energyEstimator, weather);
+TrendHelper trends(display, sensors, weather, energyEstimator);
+PanelUpdater panelUpdater(display);
+WarmStart warmStart(sensors, weather, energyEstimator, wifi);
+
+// Heap allocations made by the trend rendering poll (should stay at zero, like the render tasks)
+uint32_t renderAllocations = 0;
+
+// Latency of what loop() runs itself; the scheduler times each of its tasks
+struct LoopProbes {
+    PerfStats::Probe *loop; // One whole pass, without the idle nap
+    PerfStats::Probe *display;
+    PerfStats::Probe *trends;
+    PerfStats::Probe *console;
+} probes;
+
+bool mainShown = false; // Main page opened after the start page
+
+/* ---------- Console commands ---------- */
+// "<label><value><unit>" on a line of its own
+template <typename T>
+void printLine(Print &out, const char *label, const T &value, const char *unit = "") {
+    out.print(label);
+    out.print(value);
+    out.println(unit);
+}
+
+// Milliseconds since boot, or "pending" for a milestone not reached yet
+void printStartupTime(Print &out, uint32_t ms) {
+    if (ms) {
+        out.print(ms);
+        out.print(" ms");
+    } else {
+        out.print("pending");
+    }
+}
+
+const char *acStateName(ACPowerState state) {
+    switch (state) {
+    case ACPowerState::OFF:
+        return "OFF";
+    case ACPowerState::STARTING:
+        return "STARTING";
+    case ACPowerState::RUNNING:
+        return "RUNNING";
+    case ACPowerState::IDLE:
+        return "IDLE";
+    }
+    return "";
+}
+
+// Configuration and monitoring commands
+void cmdRecommendedConfig(Print &out, const char *, void *) {
+    out.println();
+    energyEstimator.printConfigRecommendations(out);
+}
+
+void cmdHeatLoadDetails(Print &out, const char *, void *) {
+    out.println();
+    energyEstimator.printHeatLoadDetails(out);
+}
+
+void cmdHeatLoadSummary(Print &out, const char *, void *) {
+    out.println();
+    energyEstimator.printHeatLoadSummary(out);
+    out.println();
+}
+
+// AC state control commands
+void cmdAcOn(Print &out, const char *, void *) {
+    energyEstimator.setACOn();
+    out.println("AC turned ON (will start in STARTING state)");
+}
+
+void cmdAcOff(Print &out, const char *, void *) {
+    energyEstimator.setACOff();
+    out.println("AC turned OFF");
+}
+
+// System status commands
+void cmdStatus(Print &out, const char *, void *) {
+    out.println("\n=== SYSTEM STATUS ===");
+    printLine(out, "Uptime: ", (uint32_t)(Clock::nowMs() / 1000), " s");
+    printLine(out, "AC State: ", acStateName(energyEstimator.getACState()));
+    printLine(out, "Current Power: ", energyEstimator.getEstimatedPowerWatts(), "W");
+    printLine(out, "Heat Load: ", energyEstimator.getCurrentHeatLoadWatts(), "W");
+    printLine(out, "Indoor Temp: ", sensors.getIndoorTemp(), "°C");
+    printLine(out, "Indoor Humidity: ", sensors.getIndoorHumidity(), "%");
+    printLine(out, "Outdoor Temp: ", weather.getCurrentTemp(), "°C");
+    printLine(out, "Outdoor Humidity: ", weather.getCurrentHumidity(), "%");
+    printLine(out, "Data Valid: ", sensors.isDataValid() ? "Yes" : "No");
+    printLine(out, "Target Temp: ", Config::TARGET_INDOOR_TEMP, "°C");
+    printLine(out, "Temp Difference: ", abs(weather.getCurrentTemp() - sensors.getIndoorTemp()), "°C");
+    printLine(out, "Display Page: ", display.getCurrentPage(), display.isAsleep() ? " (asleep)" : "");
+    printLine(out, "Display Command Errors: ", display.getCommandErrors());
+    printLine(out, "Display Baud Rate: ", display.getBaudRate());
+
+    out.print("Display Writes Skipped: ");
+    out.print(display.getSkippedWrites());
+    printLine(out, " (", display.getSkippedBytes(), " bytes)");
+    out.print("Display Writes Deferred: ");
+    out.print(display.getDeferredWrites());
+    printLine(out, " (", display.getCoalescedWrites(), " coalesced)");
+    out.print("Display Queue: ");
+    out.print(display.getQueueDepth());
+    out.print(" (max ");
+    out.print(display.getMaxQueueDepth());
+    out.print("), latency avg ");
+    out.print(display.getAverageLatencyMs());
+    printLine(out, " ms, max ", display.getMaxLatencyMs(), " ms");
+
+    const DisplayManager::LinkUsage &link = display.getLinkLastWindow();
+    const DisplayManager::LinkUsage &peak = display.getLinkPeakWindow();
+    out.print("Display Link (per ");
+    out.print(Config::DISPLAY_LINK_WINDOW_MS / 1000);
+    out.print(" s): tx ");
+    out.print(link.txBytes);
+    out.print(" bytes, ");
+    out.print(link.txCommands);
+    out.print(" commands, ");
+    out.print(link.txWireMs);
+    out.print(" ms; rx ");
+    out.print(link.rxBytes);
+    out.print(" bytes, ");
+    out.print(link.rxWireMs);
+    printLine(out, " ms; peak tx ", peak.txWireMs, " ms");
+    out.print("Display Sleep: ");
+    out.print(display.getSleepAvoidedWrites());
+    printLine(out, " writes avoided, ", display.getWakeReplayedWrites(), " replayed on wake");
+
+    out.print("Heap Allocations: ");
+    out.print(HeapStats::getAllocations());
+    printLine(out, " (", HeapStats::getAllocatedBytes(), " bytes)");
+    printLine(out, "Render Loop Allocations: ", renderAllocations + scheduler.getUnexpectedAllocations());
+
+    out.print("Events:");
+    for (uint8_t i = 0; i < (uint8_t)Event::COUNT; i++) {
+        out.print(' ');
+        out.print(EventBus::getName((Event)i));
+        out.print(' ');
+        out.print(events.getPublished((Event)i));
+    }
+    out.println();
+    out.print("Recomputes Avoided: energy ");
+    out.print(energyEstimator.getSkippedRecalculations());
+    out.print(" (");
+    out.print(energyEstimator.getRecalculations());
+    out.print(" run), alerts ");
+    out.print(alertManager.getSkippedChecks());
+    out.print(" (");
+    out.print(alertManager.getChecks());
+    printLine(out, " run), upload chunks ", thingsBoard.getSkippedChunks());
+    out.print("Loop Busy: ");
+    out.print(power.getLoopBusyPercent(), 1);
+    out.print("% of the last ");
+    out.print(Config::POWER_WINDOW_MS / 1000);
+    out.println(" s");
+    out.print("Warm Start: ");
+    out.print(warmStart.isRestored() ? "restored (" : "cold (");
+    out.print(ESP.getResetReason());
+    printLine(out, "), ", warmStart.getSnapshots(), " snapshots");
+    out.print("Startup: first reading ");
+    printStartupTime(out, sensors.getFirstReadingMs());
+    out.print(", Wi-Fi ");
+    printStartupTime(out, wifi.getFirstConnectMs());
+    out.print(", first upload ");
+    printStartupTime(out, thingsBoard.getFirstUploadMs());
+    out.println();
+}
+
+// Sensor information commands
+void cmdSensorInfo(Print &out, const char *, void *) {
+    out.println("\n=== SENSOR INFO ===");
+    sensors.printIndoorTemp(out);
+    out.println();
+    sensors.printIndoorRh(out);
+    out.println();
+    out.println(sensors.getIndoorStatusString());
+    sensors.printCoValue(out);
+    out.println();
+    out.println(sensors.getCoStatusString());
+    out.println(sensors.getOzoneStatusString());
+    printLine(out, "CO Warmed Up: ", sensors.isCoSensorWarmedUp() ? "Yes" : "No");
+    printLine(out, "Ozone Warmed Up: ", sensors.isOzoneSensorWarmedUp() ? "Yes" : "No");
+    printLine(out, "DHT22 Decode Failures: ", sensors.getDhtDecodeFailures());
+    printLine(out, "DHT22 Checksum Errors: ", sensors.getDhtChecksumErrors());
+}
+
+// Energy information commands
+void cmdEnergyInfo(Print &out, const char *, void *) {
+    out.println("\n=== ENERGY INFO ===");
+    energyEstimator.printCurrentDraw(out);
+    out.println();
+    energyEstimator.printDailyEstimate(out);
+    out.println();
+    out.println(energyEstimator.getEnergyStatusString());
+    out.print("Today's Runtime: ");
+    out.print(energyEstimator.getTodaysRuntimeHours(), 2);
+    out.println(" hours");
+    out.print("Today's Energy: ");
+    out.print(energyEstimator.getTodaysEnergyKWh(), 3);
+    out.println(" kWh");
+    printLine(out, "Current COP: ", energyEstimator.getCurrentCOP());
+    printLine(out, "Current EER: ", energyEstimator.getEER());
+}
+
+// Weather information commands
+void cmdWeatherInfo(Print &out, const char *, void *) {
+    out.println("\n=== WEATHER INFO ===");
+    weather.printOutdoorTemp(out);
+    out.println();
+    weather.printOutdoorRh(out);
+    out.println();
+    printLine(out, "Raw Temp: ", weather.getCurrentTemp(), "°C");
+    printLine(out, "Raw Humidity: ", weather.getCurrentHumidity(), "%");
+}
+
+// Alert system commands
+void cmdAlertInfo(Print &out, const char *, void *) {
+    out.println("\n=== ALERT INFO ===");
+    out.println("Alert Manager Status: Active");
+    // Add any alert-specific status information if available
+}
+
+// Diagnostic commands
+void cmdAutoStart(Print &out, const char *, void *) {
+    printLine(out, "Would auto-start: ", energyEstimator.wouldAutoStart() ? "Yes" : "No");
+    printLine(out, "Heat load threshold: ", Config::AUTO_ON_HEAT_LOAD_THRESHOLD, "W");
+    printLine(out, "Current heat load: ", energyEstimator.getCurrentHeatLoadWatts(), "W");
+}
+
+void cmdAutoStop(Print &out, const char *, void *) {
+    printLine(out, "Would auto-stop: ", energyEstimator.wouldAutoStop() ? "Yes" : "No");
+    printLine(out, "Heat load threshold: ", Config::AUTO_OFF_HEAT_LOAD_THRESHOLD, "W");
+    printLine(out, "Current heat load: ", energyEstimator.getCurrentHeatLoadWatts(), "W");
+}
+
+void cmdPowerAnalysis(Print &out, const char *, void *) {
+    out.println("\n=== POWER ANALYSIS ===");
+    float heatLoad = energyEstimator.getCurrentHeatLoadWatts();
+    float currentPower = energyEstimator.getEstimatedPowerWatts();
+    float tempDiff = abs(weather.getCurrentTemp() - sensors.getIndoorTemp());
+
+    printLine(out, "Current Heat Load: ", heatLoad, "W");
+    printLine(out, "Current Power Draw: ", currentPower, "W");
+    printLine(out, "Temperature Difference: ", tempDiff, "°C");
+
+    out.println("\nPower Configuration:");
+    printLine(out, "- AC Base Power: ", Config::AC_BASE_POWER_WATTS, "W");
+    printLine(out, "- AC Min Power: ", Config::AC_MIN_POWER_WATTS, "W");
+    printLine(out, "- AC Max Power: ", Config::AC_MAX_POWER_WATTS, "W");
+    printLine(out, "- Fan Only Power: ", Config::AC_FAN_ONLY_POWER_WATTS, "W");
+
+    out.println("\nThresholds:");
+    printLine(out, "- Auto ON threshold: ", Config::AUTO_ON_HEAT_LOAD_THRESHOLD, "W");
+    printLine(out, "- Auto OFF threshold: ", Config::AUTO_OFF_HEAT_LOAD_THRESHOLD, "W");
+    printLine(out, "- Target temperature: ", Config::TARGET_INDOOR_TEMP, "°C");
+    printLine(out, "- Temperature deadband: ", Config::TEMP_DEADBAND, "°C");
+
+    if (heatLoad < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) {
+        out.println("\n** DIAGNOSIS: Heat load is below AUTO_OFF threshold **");
+        out.println("   This explains why power consumption is low.");
+    } else if (tempDiff <= Config::TEMP_DEADBAND) {
+        out.println("\n** DIAGNOSIS: Temperature difference is within deadband **");
+        out.println("   AC is likely in IDLE mode (fan only).");
+    }
+}
+
+void cmdForceCalculation(Print &out, const char *, void *) {
+    out.println("Forcing energy calculation update...");
+    energyEstimator.calculate(); // Force a calculation
+    out.println("Calculation complete. Check status for updated values.");
+}
+
+void cmdTasks(Print &out, const char *, void *) {
+    out.println("\n=== SCHEDULER TASKS ===");
+    for (uint8_t id = 0; id < scheduler.getTaskCount(); id++) {
+        const Scheduler::TaskStats &task = scheduler.getStats(id);
+        out.print(task.name);
+        out.print(": ");
+        out.print(task.runs);
+        out.print(" runs, late avg ");
+        out.print(scheduler.getAverageLateMs(id));
+        out.print(" ms, max ");
+        out.print(task.maxLateMs);
+        out.print(" ms, ");
+        out.print(task.missed);
+        out.print(" missed, longest run ");
+        out.print(task.runTime ? task.runTime->maxUs / 1000 : 0);
+        out.print(" ms, ");
+        out.print(task.allocations);
+        out.println(" allocations");
+    }
+    printLine(out, "Next deadline in ", scheduler.msUntilNext(), " ms");
+}
+
+void cmdPerf(Print &out, const char *, void *) {
+    out.println("\n=== LOOP LATENCY (us) ===");
+    for (uint8_t i = 0; i < PerfStats::getProbeCount(); i++) {
+        const PerfStats::Probe &probe = PerfStats::getProbe(i);
+        out.print(probe.name);
+        out.print(": ");
+        out.print(probe.count);
+        out.print(" runs, p50 ");
+        out.print(PerfStats::percentileUs(probe, 50));
+        out.print(", p99 ");
+        out.print(PerfStats::percentileUs(probe, 99));
+        printLine(out, ", max ", probe.maxUs);
+    }
+    out.println("Percentiles are bucket upper bounds (within 2x); max is exact");
+}
+
+void cmdPerfReset(Print &out, const char *, void *) {
+    PerfStats::reset();
+    out.println("Latency histograms cleared");
+}
+
+void cmdTrace(Print &out, const char *args, void *) {
+    if (!strcmp(args, "on")) {
+        Tracer::setRecording(true);
+        out.println(Tracer::recording ? "Tracing on" : "Tracing is compiled out (TRACE_SPANS is 0)");
+    } else if (!strcmp(args, "off")) {
+        Tracer::setRecording(false);
+        out.println("Tracing off");
+    } else if (!strcmp(args, "clear")) {
+        Tracer::clear();
+        out.println("Trace cleared");
+    } else if (!*args) {
+        Tracer::dump(out);
+    } else {
+        out.println("Usage: trace [on|off|clear]");
+    }
+}
+
+void cmdHelp(Print &out, const char *, void *) {
+    out.println("\n=== AVAILABLE COMMANDS ===");
+    console.printCommands(out);
+    out.println("");
+    out.println("=== TROUBLESHOOTING TIPS ===");
+    out.println("If power shows only ~57W with AC running:");
+    out.println("1. Check 'status' - AC might be in IDLE state");
+    out.println("2. Run 'powerAnalysis' for detailed diagnosis");
+    out.println("3. Check if heat load < 400W (auto-idle threshold)");
+    out.println("4. Use 'acOff' then 'acOn' to restart AC");
+}
+
+// Sorted by name: the console looks commands up by binary search
+constexpr ConsoleCommand COMMANDS[] = {
+    {"acOff", "Turn AC off", cmdAcOff, nullptr},
+    {"acOn", "Turn AC on", cmdAcOn, nullptr},
+    {"alertInfo", "Show alert system status", cmdAlertInfo, nullptr},
+    {"autoStart", "Check if AC would auto-start", cmdAutoStart, nullptr},
+    {"autoStop", "Check if AC would auto-stop", cmdAutoStop, nullptr},
+    {"energyInfo", "Show energy consumption info", cmdEnergyInfo, nullptr},
+    {"forceCalculation", "Force energy calculation update", cmdForceCalculation, nullptr},
+    {"heatLoadDetails", "Show detailed heat load analysis", cmdHeatLoadDetails, nullptr},
+    {"heatLoadSummary", "Show heat load summary", cmdHeatLoadSummary, nullptr},
+    {"help", "Show this help message", cmdHelp, nullptr},
+    {"perf", "Show p50/p99/max latency of the loop, its polls and each task", cmdPerf, nullptr},
+    {"perfReset", "Clear the latency histograms", cmdPerfReset, nullptr},
+    {"powerAnalysis", "Detailed power consumption analysis", cmdPowerAnalysis, nullptr},
+    {"recommendedConfig", "Show configuration recommendations", cmdRecommendedConfig, nullptr},
+    {"sensorInfo", "Show sensor readings", cmdSensorInfo, nullptr},
+    {"status", "Show complete system status", cmdStatus, nullptr},
+    {"tasks", "Show scheduler task timing (lateness, missed deadlines)", cmdTasks, nullptr},
+    {"trace", "Dump the span trace; 'trace on|off|clear' to control it", cmdTrace, nullptr},
+    {"weatherInfo", "Show weather data", cmdWeatherInfo, nullptr},
+};
+static_assert(Console::isSorted(COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0])), "keep COMMANDS sorted by name");
 
 /* ---------- Arduino lifecycle ---------- */
 void setup() {
-    Serial.begin(9600);
+    console.begin();
+    console.setCommands(COMMANDS);
+    probes = {PerfStats::add("loop"), PerfStats::add("display"), PerfStats::add("trends"), PerfStats::add("console")};
     display.begin();
 
-    wifi.begin();
-}
-
-void handleSerialCommands() {
-    if (Serial.available()) {
-        String command = Serial.readStringUntil('\n');
-        command.trim(); // Remove whitespace and newlines
-
-        // Configuration and monitoring commands
-        if (command == "recommendedConfig") {
-            Serial.println("\n" + energyEstimator.getConfigRecommendations());
-        } else if (command == "heatLoadDetails") {
-            Serial.println("\n" + energyEstimator.getHeatLoadDetails());
-        } else if (command == "heatLoadSummary") {
-            Serial.println("\n" + energyEstimator.getHeatLoadSummary());
-        }
-
-        // AC state control commands
-        else if (command == "acOn") {
-            energyEstimator.setACOn();
-            Serial.println("AC turned ON (will start in STARTING state)");
-        } else if (command == "acOff") {
-            energyEstimator.setACOff();
-            Serial.println("AC turned OFF");
-        }
-
-        // System status commands
-        else if (command == "status") {
-            Serial.println("\n=== SYSTEM STATUS ===");
-
-            // Convert AC state enum to readable string
-            String acStateStr = "";
-            switch (energyEstimator.getACState()) {
-            case ACPowerState::OFF:
-                acStateStr = "OFF";
-                break;
-            case ACPowerState::STARTING:
-                acStateStr = "STARTING";
-                break;
-            case ACPowerState::RUNNING:
-                acStateStr = "RUNNING";
-                break;
-            case ACPowerState::IDLE:
-                acStateStr = "IDLE";
-                break;
-            }
-
-            Serial.println("AC State: " + acStateStr);
-            Serial.println("Current Power: " + String(energyEstimator.getEstimatedPowerWatts()) + "W");
-            Serial.println("Heat Load: " + String(energyEstimator.getCurrentHeatLoadWatts()) + "W");
-            Serial.println("Indoor Temp: " + String(sensors.getIndoorTemp()) + "°C");
-            Serial.println("Indoor Humidity: " + String(sensors.getIndoorHumidity()) + "%");
-            Serial.println("Outdoor Temp: " + String(weather.getCurrentTemp()) + "°C");
-            Serial.println("Outdoor Humidity: " + String(weather.getCurrentHumidity()) + "%");
-            Serial.println("Data Valid: " + String(sensors.isDataValid() ? "Yes" : "No"));
-            Serial.println("Target Temp: " + String(Config::TARGET_INDOOR_TEMP) + "°C");
-            Serial.println("Temp Difference: " + String(abs(weather.getCurrentTemp() - sensors.getIndoorTemp())) + "°C");
-        }
-
-        // Sensor information commands
-        else if (command == "sensorInfo") {
-            Serial.println("\n=== SENSOR INFO ===");
-            Serial.println(sensors.getIndoorTempString());
-            Serial.println(sensors.getIndoorRhString());
-            Serial.println(sensors.getIndoorStatusString());
-            Serial.println(sensors.getCoValueString());
-            Serial.println(sensors.getCoStatusString());
-            Serial.println(sensors.getOzoneStatusString());
-            Serial.println("CO Warmed Up: " + String(sensors.isCoSensorWarmedUp() ? "Yes" : "No"));
-            Serial.println("Ozone Warmed Up: " + String(sensors.isOzoneSensorWarmedUp() ? "Yes" : "No"));
-        }
-
-        // Energy information commands
-        else if (command == "energyInfo") {
-            Serial.println("\n=== ENERGY INFO ===");
-            Serial.println(energyEstimator.getCurrentDrawString());
-            Serial.println(energyEstimator.getDailyEstimateString());
-            Serial.println(energyEstimator.getEnergyStatusString());
-            Serial.println("Today's Runtime: " + String(energyEstimator.getTodaysRuntimeHours(), 2) + " hours");
-            Serial.println("Today's Energy: " + String(energyEstimator.getTodaysEnergyKWh(), 3) + " kWh");
-            Serial.println("Current COP: " + String(energyEstimator.getCurrentCOP(), 2));
-            Serial.println("Current EER: " + String(energyEstimator.getEER(), 2));
-        }
-
-        // Weather information commands
-        else if (command == "weatherInfo") {
-            Serial.println("\n=== WEATHER INFO ===");
-            Serial.println(weather.getOutdoorTempString());
-            Serial.println(weather.getOutdoorRhString());
-            Serial.println("Raw Temp: " + String(weather.getCurrentTemp()) + "°C");
-            Serial.println("Raw Humidity: " + String(weather.getCurrentHumidity()) + "%");
-        }
-
-        // Alert system commands
-        else if (command == "alertInfo") {
-            Serial.println("\n=== ALERT INFO ===");
-            Serial.println("Alert Manager Status: Active");
-            // Add any alert-specific status information if available
-        }
-
-        // Diagnostic commands
-        else if (command == "autoStart") {
-            bool wouldStart = energyEstimator.wouldAutoStart();
-            Serial.println("Would auto-start: " + String(wouldStart ? "Yes" : "No"));
-            Serial.println("Heat load threshold: " + String(Config::AUTO_ON_HEAT_LOAD_THRESHOLD) + "W");
-            Serial.println("Current heat load: " + String(energyEstimator.getCurrentHeatLoadWatts()) + "W");
-        } else if (command == "autoStop") {
-            bool wouldStop = energyEstimator.wouldAutoStop();
-            Serial.println("Would auto-stop: " + String(wouldStop ? "Yes" : "No"));
-            Serial.println("Heat load threshold: " + String(Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) + "W");
-            Serial.println("Current heat load: " + String(energyEstimator.getCurrentHeatLoadWatts()) + "W");
-        } else if (command == "powerAnalysis") {
-            Serial.println("\n=== POWER ANALYSIS ===");
-            float heatLoad = energyEstimator.getCurrentHeatLoadWatts();
-            float currentPower = energyEstimator.getEstimatedPowerWatts();
-            float tempDiff = abs(weather.getCurrentTemp() - sensors.getIndoorTemp());
-
-            Serial.println("Current Heat Load: " + String(heatLoad) + "W");
-            Serial.println("Current Power Draw: " + String(currentPower) + "W");
-            Serial.println("Temperature Difference: " + String(tempDiff) + "°C");
-
-            Serial.println("\nPower Configuration:");
-            Serial.println("- AC Base Power: " + String(Config::AC_BASE_POWER_WATTS) + "W");
-            Serial.println("- AC Min Power: " + String(Config::AC_MIN_POWER_WATTS) + "W");
-            Serial.println("- AC Max Power: " + String(Config::AC_MAX_POWER_WATTS) + "W");
-            Serial.println("- Fan Only Power: " + String(Config::AC_FAN_ONLY_POWER_WATTS) + "W");
-
-            Serial.println("\nThresholds:");
-            Serial.println("- Auto ON threshold: " + String(Config::AUTO_ON_HEAT_LOAD_THRESHOLD) + "W");
-            Serial.println("- Auto OFF threshold: " + String(Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) + "W");
-            Serial.println("- Target temperature: " + String(Config::TARGET_INDOOR_TEMP) + "°C");
-            Serial.println("- Temperature deadband: " + String(Config::TEMP_DEADBAND) + "°C");
-
-            if (heatLoad < Config::AUTO_OFF_HEAT_LOAD_THRESHOLD) {
-                Serial.println("\n** DIAGNOSIS: Heat load is below AUTO_OFF threshold **");
-                Serial.println("   This explains why power consumption is low.");
-            } else if (tempDiff <= Config::TEMP_DEADBAND) {
-                Serial.println("\n** DIAGNOSIS: Temperature difference is within deadband **");
-                Serial.println("   AC is likely in IDLE mode (fan only).");
-            }
-        } else if (command == "forceCalculation") {
-            Serial.println("Forcing energy calculation update...");
-            energyEstimator.poll(); // Force a calculation
-            Serial.println("Calculation complete. Check status for updated values.");
-        }
-
-        // Help command
-        else if (command == "help") {
-            Serial.println("\n=== AVAILABLE COMMANDS ===");
-            Serial.println("Configuration & Monitoring:");
-            Serial.println("  recommendedConfig - Show configuration recommendations");
-            Serial.println("  heatLoadDetails   - Show detailed heat load analysis");
-            Serial.println("  heatLoadSummary   - Show heat load summary");
-            Serial.println("");
-            Serial.println("AC Control:");
-            Serial.println("  acOn              - Turn AC on");
-            Serial.println("  acOff             - Turn AC off");
-            Serial.println("");
-            Serial.println("System Status:");
-            Serial.println("  status            - Show complete system status");
-            Serial.println("  sensorInfo        - Show sensor readings");
-            Serial.println("  energyInfo        - Show energy consumption info");
-            Serial.println("  weatherInfo       - Show weather data");
-            Serial.println("  alertInfo         - Show alert system status");
-            Serial.println("");
-            Serial.println("Diagnostics:");
-            Serial.println("  autoStart         - Check if AC would auto-start");
-            Serial.println("  autoStop          - Check if AC would auto-stop");
-            Serial.println("  powerAnalysis     - Detailed power consumption analysis");
-            Serial.println("  forceCalculation  - Force energy calculation update");
-            Serial.println("  help              - Show this help message");
-            Serial.println("");
-            Serial.println("=== TROUBLESHOOTING TIPS ===");
-            Serial.println("If power shows only ~57W with AC running:");
-            Serial.println("1. Check 'status' - AC might be in IDLE state");
-            Serial.println("2. Run 'powerAnalysis' for detailed diagnosis");
-            Serial.println("3. Check if heat load < 400W (auto-idle threshold)");
-            Serial.println("4. Use 'acOff' then 'acOn' to restart AC");
-        }
-
-        // Unknown command
-        else {
-            Serial.println("Unknown command: " + command);
-            Serial.println("Type 'help' for available commands");
-        }
-    }
+    // Local components first: they run from the first loop pass, whatever the network does
+    sensors.begin(scheduler, events);
+    energyEstimator.begin(scheduler, events);
+    alertManager.begin(scheduler, events);
+    trends.begin();
+
+    // Network components wait in their own tasks until Wi-Fi is up
+    wifi.begin(scheduler);
+    timeManager.begin(scheduler);
+    weather.begin(scheduler, events);
+    thingsBoard.begin(scheduler, events);
+    panelUpdater.begin(console);
+    power.begin();
+
+    // After a watchdog or crash reset, pick up where the previous run left off
+    warmStart.restore();
+    warmStart.begin(scheduler);
 }
 
 void loop() {
-    // Wait for Wi-Fi connection before initializing other components
-    if (wifi.poll()) {
-        // Initialize all components once Wi-Fi is connected
-        timeManager.begin();
-        sensors.begin();
-        weather.begin();
-        energyEstimator.begin();
-        thingsBoard.begin();
-        alertManager.begin();
-
-        delay(Config::COMPONENT_INIT_DELAY_MS); // Allow components to initialize
+    uint32_t loopStart = PerfStats::start();
+
+    // Process panel events (page changes, sleep/wake) before anything writes to it
+    uint32_t start = PerfStats::start();
+    display.poll();
+    PerfStats::record(probes.display, start);
+
+    // Leave the startup progress up briefly; nothing waits for it
+    if (!mainShown && Clock::reached(Config::STARTUP_SPLASH_MS)) {
+        mainShown = true;
         display.showMain();
     }
 
-    // Poll all components continuously
-    timeManager.poll();
-    weather.poll();
-    sensors.poll();         // Poll sensors continuously
-    energyEstimator.poll(); // Calculate energy usage
-    thingsBoard.poll();     // Upload data to ThingsBoard
-    alertManager.poll();    // Check for alerts and manage buzzer
+    // Wi-Fi, clock, sensors, weather, energy, uploads and alerts, each when its deadline comes
+    scheduler.runDue();
 
-    // Handle serial commands for debugging
-    handleSerialCommands();
+    // Rendering only formats into fixed buffers; count any heap use it makes
+    uint32_t allocationsBefore = HeapStats::getAllocations();
+    start = PerfStats::start();
+    trends.poll(); // Record history and stream it to the trend graphs
+    PerfStats::record(probes.trends, start);
+    renderAllocations += HeapStats::getAllocations() - allocationsBefore;
+
+    // Handle console commands for debugging (never waits for a line to finish)
+    start = PerfStats::start();
+    console.poll();
+    PerfStats::record(probes.console, start);
+
+    PerfStats::record(probes.loop, loopStart);
+
+    // Nothing due: sleep towards the next deadline, woken early by panel input or ozone
+    uint32_t idle = scheduler.msUntilNext();
+    if (idle > 0) {
+        power.idle(idle);
+    }
 }
@@ -0,0 +1,176 @@
+#pragma once
+#include <Arduino.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+// Nextion panel on the far end of the fake Serial. It executes what the firmware sends against a
+// page/component list and answers the way the panel does with bkcmd=3: 0x01 for success, 0x1A
+// for a name it does not know, 0x66 for sendme, 0xFE/0xFD around transparent (addt) data. Sleep
+// and wake are reported when the test calls sleep()/wake(). Replies are queued at once; the link
+// statistics turn byte counts into wire time, so the answer delay does not change them.
+class PanelEmulator {
+public:
+    struct Stats {
+        uint32_t commands;       // Terminated commands received
+        uint32_t rejected;       // Answered with an error code
+        uint32_t whileAsleep;    // Received while asleep, other than the wake command
+        uint32_t pageChanges;
+        uint32_t transparentBytes;
+    };
+
+    // rtc: whether rtc0..rtc6 exist (Enhanced and Intelligent series, not Basic)
+    explicit PanelEmulator(bool rtc = true) : _rtc(rtc) { Serial.setListener(onByte, this); }
+
+    // Components on a page; those of other pages are reachable as "<page>.<name>" (global scope)
+    void addPage(const char *name, std::initializer_list<const char *> components) {
+        Page &page = _pages[_pageCount];
+        page.name = name;
+        page.components.insert(components.begin(), components.end());
+        _pageCount++;
+    }
+
+    void sleep() {
+        _asleep = true;
+        send({0x86});
+    }
+    void wake() {
+        _asleep = false;
+        send({0x87});
+    }
+    // Touch navigation: the firmware only learns about it from sendme
+    void touchPage(uint8_t id) { setPage(id); }
+
+    uint8_t getPage() const { return _page; }
+    bool isAsleep() const { return _asleep; }
+    uint8_t getBkcmd() const { return _bkcmd; }
+    const Stats &getStats() const { return _stats; }
+    void resetStats() { _stats = {}; }
+    const std::string &getText(const std::string &element) { return _text[element]; }
+    bool isVisible(const std::string &element) { return _visible[element]; }
+
+private:
+    struct Page {
+        std::string name;
+        std::set<std::string> components;
+    };
+
+    static constexpr uint8_t REPLY_OK = 0x01;
+    static constexpr uint8_t REPLY_INVALID_VARIABLE = 0x1A;
+    static constexpr uint8_t REPLY_PAGE = 0x66;
+    static constexpr uint8_t REPLY_TRANSPARENT_READY = 0xFE;
+    static constexpr uint8_t REPLY_TRANSPARENT_DONE = 0xFD;
+
+    static void onByte(uint8_t c, void *ptr) { static_cast<PanelEmulator *>(ptr)->receive(c); }
+
+    void receive(uint8_t c) {
+        if (_transparentLeft > 0) {
+            _stats.transparentBytes++;
+            if (--_transparentLeft == 0) send({REPLY_TRANSPARENT_DONE});
+            return;
+        }
+        if (c != 0xFF) {
+            _line += (char)c;
+            _ffCount = 0;
+            return;
+        }
+        if (++_ffCount < 3) return;
+        _ffCount = 0;
+        execute(_line);
+        _line.clear();
+    }
+
+    void execute(const std::string &cmd) {
+        _stats.commands++;
+        if (_asleep && cmd != "sleep=0") _stats.whileAsleep++;
+
+        unsigned a = 0, b = 0, count = 0;
+        char name[64];
+        if (cmd.empty()) {
+            return; // Sent to end a partial command; never answered
+        } else if (sscanf(cmd.c_str(), "bkcmd=%u", &a) == 1) {
+            _bkcmd = a;
+            reply(true);
+        } else if (cmd == "sendme") {
+            send({REPLY_PAGE, _page});
+        } else if (cmd.compare(0, 5, "page ") == 0) {
+            int id = pageId(cmd.substr(5));
+            if (id >= 0) setPage(id);
+            reply(id >= 0);
+        } else if (sscanf(cmd.c_str(), "vis %63[^,],%u", name, &a) == 2) {
+            bool known = _pages[_page].components.count(name) > 0;
+            if (known) _visible[qualify(name)] = a;
+            reply(known);
+        } else if (sscanf(cmd.c_str(), "addt %u,%u,%u", &a, &b, &count) == 3) {
+            _transparentLeft = count;
+            send({REPLY_TRANSPARENT_READY});
+        } else if (cmd.find(".txt=\"") != std::string::npos) {
+            std::string element = qualify(cmd.substr(0, cmd.find(".txt=")));
+            bool known = isComponent(element);
+            if (known) _text[element] = cmd.substr(cmd.find('"') + 1, cmd.size() - cmd.find('"') - 2);
+            reply(known);
+        } else if (cmd == "sleep=0") {
+            if (_asleep) wake();
+            reply(true);
+        } else if (cmd.compare(0, 3, "rtc") == 0 && !_rtc) {
+            reply(false);
+        } else {
+            reply(true); // baud, thsp, thup, ref_stop/ref_star, cle, rtcN=...
+        }
+    }
+
+    void reply(bool ok) {
+        if (ok && (_bkcmd == 1 || _bkcmd == 3)) send({REPLY_OK});
+        if (!ok) {
+            _stats.rejected++;
+            if (_bkcmd >= 2) send({REPLY_INVALID_VARIABLE});
+        }
+    }
+
+    void send(std::initializer_list<uint8_t> frame) {
+        Serial.receive(frame.begin(), frame.size());
+        static const uint8_t TERMINATOR[] = {0xFF, 0xFF, 0xFF};
+        Serial.receive(TERMINATOR, sizeof(TERMINATOR));
+    }
+
+    void setPage(uint8_t id) {
+        if (id != _page) _stats.pageChanges++;
+        _page = id;
+        // Components start from their HMI defaults on every page load
+        for (const std::string &component : _pages[id].components) {
+            _text.erase(_pages[id].name + "." + component);
+            _visible.erase(_pages[id].name + "." + component);
+        }
+    }
+
+    int pageId(const std::string &nameOrId) const {
+        for (uint8_t i = 0; i < _pageCount; i++) {
+            if (_pages[i].name == nameOrId || std::to_string(i) == nameOrId) return i;
+        }
+        return -1;
+    }
+
+    std::string qualify(const std::string &element) const {
+        return element.find('.') == std::string::npos ? _pages[_page].name + "." + element : element;
+    }
+
+    bool isComponent(const std::string &qualified) const {
+        size_t dot = qualified.find('.');
+        int page = pageId(qualified.substr(0, dot));
+        return page >= 0 && _pages[page].components.count(qualified.substr(dot + 1)) > 0;
+    }
+
+    const bool _rtc;
+    Page _pages[8];
+    uint8_t _pageCount = 0;
+    uint8_t _page = 0;
+    uint8_t _bkcmd = 2; // Power-on default: failures only
+    bool _asleep = false;
+    std::string _line;
+    uint8_t _ffCount = 0;
+    uint32_t _transparentLeft = 0;
+    std::map<std::string, std::string> _text;
+    std::map<std::string, bool> _visible;
+    Stats _stats = {};
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdio>
+
+// Just enough of a test framework for the host tests: a failed check prints its line and the
+// run continues, main() returns checkResult() so make stops on the first failing binary
+namespace check {
+inline int checks = 0;
+inline int failures = 0;
+} // namespace check
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        check::checks++;                                                        \
+        if (!(cond)) {                                                          \
+            check::failures++;                                                  \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);     \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                              \
+    do {                                                                        \
+        long long actual_ = (long long)(actual);                                \
+        long long expected_ = (long long)(expected);                            \
+        check::checks++;                                                        \
+        if (actual_ != expected_) {                                             \
+            check::failures++;                                                  \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__,    \
+                   #actual, actual_, expected_);                                \
+        }                                                                       \
+    } while (0)
+
+inline int checkResult(const char *name) {
+    printf("%s: %d checks, %d failed\n", name, check::checks, check::failures);
+    return check::failures ? 1 : 0;
+}
@@ -0,0 +1,52 @@
+#include <Arduino.h>
+#include <stdarg.h>
+
+namespace fake {
+    uint64_t nowUs = 0;
+}
+
+unsigned long millis() { return (uint32_t)(fake::nowUs / 1000); }
+unsigned long micros() { return (uint32_t)fake::nowUs; }
+uint64_t micros64() { return fake::nowUs; }
+void delay(unsigned long ms) { fake::advanceMs(ms); }
+void yield() {}
+
+HardwareSerial Serial;
+EspClass ESP;
+
+size_t Print::printf(const char *format, ...) {
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return len > 0 ? write((const uint8_t *)buffer, min((size_t)len, sizeof(buffer) - 1)) : 0;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    unsigned long start = millis();
+    while (count < length) {
+        int c = read();
+        if (c >= 0) {
+            buffer[count++] = (char)c;
+        } else if (millis() - start >= _timeout) {
+            break;
+        } else {
+            delay(1);
+        }
+    }
+    return count;
+}
+
+int HardwareSerial::read() {
+    if (_rx.empty()) return -1;
+    uint8_t c = _rx.front();
+    _rx.pop_front();
+    return c;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (_listener) _listener(c, _listenerPtr);
+    return 1;
+}
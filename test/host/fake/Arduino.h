@@ -0,0 +1,122 @@
+#pragma once
+// The parts of the ESP8266 Arduino core the host tests use. Time only moves when a test says so,
+// or while the code under test waits for serial input.
+#include <algorithm>
+#include <deque>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define A0 17
+#define IRAM_ATTR
+
+using std::max;
+using std::min;
+
+unsigned long millis(); // Wraps after 2^32 ms, as on the ESP8266
+unsigned long micros();
+uint64_t micros64();
+void delay(unsigned long ms);
+void yield();
+
+namespace fake {
+    extern uint64_t nowUs; // Uptime the clock functions report
+
+    inline void advanceMs(uint64_t ms) { nowUs += ms * 1000; }
+    inline void advanceUs(uint64_t us) { nowUs += us; }
+}
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &out) const = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *data, size_t size) {
+        size_t n = 0;
+        while (n < size && write(data[n])) n++;
+        return n;
+    }
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+    size_t write(const char *data, size_t size) { return write((const uint8_t *)data, size); }
+    virtual void flush() {}
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n) { return printf("%d", n); }
+    size_t print(unsigned n) { return printf("%u", n); }
+    size_t print(long n) { return printf("%ld", n); }
+    size_t print(unsigned long n) { return printf("%lu", n); }
+    size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+    size_t print(const Printable &p) { return p.printTo(*this); }
+
+    template <typename T>
+    size_t println(const T &value) { return print(value) + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { _timeout = ms; }
+    // Waits up to the timeout for the rest, like the core
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+
+protected:
+    unsigned long _timeout = 1000;
+};
+
+// UART as seen by the firmware. The test plays the device on the other end: it queues the
+// bytes the device sends with receive() and sees every byte written through the listener.
+class HardwareSerial : public Stream {
+public:
+    typedef void (*Listener)(uint8_t c, void *ptr);
+
+    void begin(unsigned long baud) { _baud = baud; }
+    void end() {}
+    void swap() {}
+    unsigned long baudRate() const { return _baud; }
+
+    int available() override { return _rx.size(); }
+    int read() override;
+    int peek() override { return _rx.empty() ? -1 : _rx.front(); }
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    void receive(const uint8_t *data, size_t len) { _rx.insert(_rx.end(), data, data + len); }
+    void setListener(Listener listener, void *ptr) {
+        _listener = listener;
+        _listenerPtr = ptr;
+    }
+
+private:
+    std::deque<uint8_t> _rx;
+    unsigned long _baud = 0;
+    Listener _listener = nullptr;
+    void *_listenerPtr = nullptr;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getCycleCount() { return (uint32_t)(fake::nowUs * 80); }
+    uint8_t getCpuFreqMHz() { return 80; }
+};
+
+extern EspClass ESP;
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+
+class IPAddress : public Printable {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _bytes{a, b, c, d} {}
+
+    size_t printTo(Print &out) const override {
+        return out.printf("%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+    }
+
+private:
+    uint8_t _bytes[4];
+};
@@ -0,0 +1,93 @@
+// Clock: 64-bit uptime from a millis() that wraps every 2^32 ms (49.7 days), over five wraps
+#include "Clock.h"
+#include "check.h"
+
+#include <random>
+
+static const uint64_t WRAP_MS = 1ULL << 32;
+
+static uint64_t trueMs() { return fake::nowUs / 1000; }
+
+// One full wrap, with the read per wrap that loop() guarantees
+static void advanceWrap() {
+    fake::advanceMs(WRAP_MS / 2);
+    Clock::nowMs();
+    fake::advanceMs(WRAP_MS / 2);
+}
+
+// Runs first: the wrap count in Clock starts at boot
+static void testLongUptime() {
+    std::mt19937 rng(1);
+    uint64_t last = Clock::nowMs();
+    uint64_t daily = 0;
+    int days = 0;
+    int wrong = 0;
+
+    // Reads up to an hour apart, as a busy loop() or a long task would leave them
+    while (trueMs() < 5 * WRAP_MS + 86400000) {
+        fake::advanceMs(rng() % 3600000);
+        uint64_t now = Clock::nowMs();
+        if (now != trueMs() || now < last) wrong++;
+        if (Clock::hasElapsed(daily, 86400000)) {
+            daily = now;
+            days++;
+        }
+        last = now;
+    }
+    CHECK_EQ(wrong, 0);
+    CHECK(Clock::detail::msWraps >= 5);
+    CHECK_EQ(Clock::detail::msWraps, trueMs() >> 32);
+    CHECK(days >= 240); // A daily task keeps firing across every wrap, each run up to an hour late
+}
+
+static void testElapsedAcrossWrap() {
+    // Just before the next wrap of millis()
+    fake::advanceMs(WRAP_MS - trueMs() % WRAP_MS - 1000);
+    uint32_t before = millis();
+    uint64_t start = Clock::nowMs();
+    uint64_t deadline = Clock::deadlineIn(5000);
+
+    fake::advanceMs(3000);
+    CHECK(millis() < before); // millis() wrapped
+    CHECK_EQ(Clock::elapsedMs(start), 3000);
+    CHECK(!Clock::hasElapsed(start, 3001));
+    CHECK(Clock::hasElapsed(start, 3000));
+    CHECK(!Clock::reached(deadline));
+
+    fake::advanceMs(2000);
+    CHECK_EQ(Clock::elapsedMs(start), 5000);
+    CHECK(Clock::reached(deadline));
+
+    // A 32-bit difference of millis() loses whole wraps; Clock only needs a read in between
+    advanceWrap();
+    CHECK_EQ(Clock::elapsedMs(start), WRAP_MS + 5000);
+    CHECK_EQ((uint32_t)(millis() - before), 5000);
+}
+
+static void testAgesAndEpoch() {
+    // An age restored after a reboot may predate boot; the wrapped timestamp still ages exactly
+    uint64_t restored = Clock::nowMs() - 8 * WRAP_MS;
+    CHECK(restored > Clock::nowMs());
+    CHECK_EQ(Clock::elapsedMs(restored), 8 * WRAP_MS);
+    fake::advanceMs(1234);
+    CHECK_EQ(Clock::elapsedMs(restored), 8 * WRAP_MS + 1234);
+
+    CHECK(!Clock::hasEpoch());
+    CHECK_EQ(Clock::epochMs(), 0);
+    uint64_t uptime = Clock::nowMs();
+    Clock::setEpoch(1700000000);
+    CHECK(Clock::hasEpoch());
+    CHECK_EQ(Clock::epochMs(), 1700000000000ULL);
+    CHECK_EQ(Clock::toEpochMs(uptime - 60000), 1700000000000ULL - 60000);
+
+    // Across the next wrap the epoch keeps counting
+    advanceWrap();
+    CHECK_EQ(Clock::epochMs(), 1700000000000ULL + WRAP_MS);
+}
+
+int main() {
+    testLongUptime();
+    testElapsedAcrossWrap();
+    testAgesAndEpoch();
+    return checkResult("test_clock");
+}
@@ -0,0 +1,280 @@
+// DisplayManager and the Nextion library against an emulated panel: one simulated minute per
+// scenario, with the firmware's update cadences, reporting the UART traffic each one costs
+#include "DisplayManager.h"
+#include "PanelEmulator.h"
+#include "check.h"
+
+static const uint32_t TICK_MS = 10; // One loop pass
+
+static void addPages(PanelEmulator &panel) {
+    panel.addPage("start", {"arduinoConn", "wifiConn", "timeSync", "dhtSensor"});
+    panel.addPage("main", {"time", "outTemp", "outRh", "inTemp", "inRh", "inStatus", "currentDraw", "dailyEst",
+                           "energyStatus", "coVal", "coStatus", "ozoneStatus", "indoorIndWarn", "energyIndWarn",
+                           "airIndWarn"});
+    panel.addPage("details", {"time", "ssid", "ipAddress", "uploadStatus", "panelUpdate", "baudRate", "latitude",
+                              "longitude", "coDetails"});
+    panel.addPage("heatload", {"time", "total", "sensible", "latent", "indoor", "outdoor", "differences",
+                               "thresholdOn", "thresholdOff", "recommendation"});
+    panel.addPage("trends", {"time", "climate", "power"});
+}
+
+// The display side of the firmware's tasks, at the periods set in Config
+class Firmware {
+public:
+    explicit Firmware(DisplayManager &disp) : _disp(disp) {
+        _disp.onPageOpen(Config::DISPLAY_PAGE_MAIN, onMainOpen, this);
+        _disp.onPageOpen(Config::DISPLAY_PAGE_HEATLOAD, onHeatLoadOpen, this);
+        _disp.onPageOpen(Config::DISPLAY_PAGE_TRENDS, onTrendsOpen, this);
+    }
+
+    void boot() {
+        _disp.begin();
+        _disp.showWifiConnecting(1);
+        _disp.showDhtInitializing();
+        run(500);
+        _disp.showWifiConnected("lab", IPAddress(192, 168, 1, 42));
+        _disp.showTimeSyncing();
+        _disp.showDhtInitialized();
+        run(300);
+        _disp.showTimeSynced();
+        run(Config::STARTUP_SPLASH_MS - 800);
+        _disp.showMain();
+        _disp.setPanelClock(clockTime());
+        _clockRunning = true; // TimeHelper starts the clock once main is up
+    }
+
+    // Advance by ms, running the tasks that fall due and polling the display every loop pass
+    void run(uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += TICK_MS) {
+            uint64_t now = Clock::nowMs();
+            if (now % Config::CLOCK_REFRESH_MS == 0) updateClock();
+            if (now % Config::ALERT_CHECK_INTERVAL_MS == 0) updateAlerts();
+            if (now % Config::SENSOR_REFRESH_MS == 0) updateSensors();
+            if (now % Config::ENERGY_CALC_REFRESH_MS == 0) updateEnergy();
+            if (now % Config::WEATHER_REFRESH_MS == 0) updateWeather();
+            if (now % Config::TREND_SAMPLE_INTERVAL_MS == 0) _trendSamples++;
+            streamTrends();
+            _disp.poll();
+            fake::advanceMs(TICK_MS);
+        }
+    }
+
+    const char *lastIndoorTemp() const { return _inTemp; }
+
+private:
+    static struct tm clockTime() {
+        time_t now = 1760000000 + Clock::nowMs() / 1000;
+        return *gmtime(&now);
+    }
+
+    // Sent only while the panel RTC does not keep the time
+    void updateClock() {
+        if (!_clockRunning || _disp.getPanelClock() == DisplayManager::PanelClock::RUNNING) return;
+        struct tm tm = clockTime();
+        char text[9];
+        snprintf(text, sizeof(text), "%02d:%02d:%02d", tm.tm_hour, tm.tm_min, tm.tm_sec);
+        _disp.updateClock(text);
+    }
+
+    // One warning stays on; re-sent every check, as AlertManager does on a changed input
+    void updateAlerts() {
+        _disp.updateIndoorIndicator(true);
+        _disp.updateEnergyIndicator(false);
+        _disp.updateAirQualityIndicator(true);
+    }
+
+    // Temperature moves a tenth every 20 s, humidity every 10 s; the CO voltage on every read
+    void updateSensors() {
+        uint64_t s = Clock::nowMs() / 1000;
+        snprintf(_inTemp, sizeof(_inTemp), "%.1f C", 24.0 + 0.1 * (s / 20 % 5));
+        char text[16];
+        _disp.updateIndoorTemp(_inTemp);
+        snprintf(text, sizeof(text), "%u %%", (unsigned)(55 + s / 10 % 3));
+        _disp.updateIndoorRh(text);
+        _disp.updateIndoorStatus("Comfortable");
+        _disp.updateCoValue("3 ppm");
+        _disp.updateCoStatus("Safe");
+        _disp.updateOzoneStatus("Normal");
+        _disp.updateCoDetails(0.41 + 0.01 * (s % 7), 127 + s % 7);
+    }
+
+    void updateEnergy() {
+        uint64_t s = Clock::nowMs() / 1000;
+        char text[16];
+        snprintf(text, sizeof(text), "%.2f A", 4.2 + 0.01 * (s % 13));
+        _disp.updateCurrentDraw(text);
+        snprintf(text, sizeof(text), "%.2f kWh", 18.5 + 0.01 * (s / 10));
+        _disp.updateDailyEstimate(text);
+        _disp.updateEnergyStatus("Normal");
+        if (_disp.isPageShown(Config::DISPLAY_PAGE_HEATLOAD)) renderHeatLoad();
+    }
+
+    void updateWeather() {
+        _disp.updateOutdoorTemp("31.2 C");
+        _disp.updateOutdoorRh("74 %");
+    }
+
+    void renderHeatLoad() {
+        uint64_t s = Clock::nowMs() / 1000;
+        char text[24];
+        snprintf(text, sizeof(text), "%.0f W", 1850.0 + s % 17);
+        _disp.updateHeatLoadTotal(text);
+        _disp.updateHeatLoadSensible("1320 W");
+        _disp.updateHeatLoadLatent("530 W");
+        _disp.updateHeatLoadIndoor("24.1 C / 56 %");
+        _disp.updateHeatLoadOutdoor("31.2 C / 74 %");
+        _disp.updateHeatLoadDifferences("7.1 C / 18 %");
+        _disp.updateHeatLoadThresholdOn("2000 W");
+        _disp.updateHeatLoadThresholdOff("1500 W");
+        _disp.updateHeatLoadRecommendation("Keep the AC on");
+    }
+
+    // Like TrendHelper: the whole history on opening, then one point per channel per sample
+    void streamTrends() {
+        static const uint8_t CHANNELS = 2;
+        while (_trendChannel < CHANNELS) {
+            uint16_t count = _trendRedraw ? HISTORY : _trendSamples;
+            if (count == 0 || !_disp.canStreamWaveform(count)) return;
+            _disp.streamWaveform(DisplayManager::Waveform::CLIMATE, _trendChannel, _history, count);
+            _trendChannel++;
+        }
+        _trendRedraw = false;
+        _trendSamples = 0;
+        _trendChannel = 0;
+    }
+
+    static void onMainOpen(void *ptr) { static_cast<Firmware *>(ptr)->updateAlerts(); }
+    static void onHeatLoadOpen(void *ptr) { static_cast<Firmware *>(ptr)->renderHeatLoad(); }
+    static void onTrendsOpen(void *ptr) {
+        Firmware *self = static_cast<Firmware *>(ptr);
+        self->_trendRedraw = true;
+        self->_trendChannel = 0;
+    }
+
+    static const uint16_t HISTORY = 240; // Points across the waveform
+
+    DisplayManager &_disp;
+    bool _clockRunning = false;
+    char _inTemp[16] = "";
+    uint8_t _history[HISTORY] = {};
+    bool _trendRedraw = false;
+    uint16_t _trendSamples = 0;
+    uint8_t _trendChannel = 0;
+};
+
+// Link traffic over one scenario
+struct Minute {
+    NexLinkStats start;
+
+    Minute() { nexGetLinkStats(&start); }
+
+    void report(const char *name, const PanelEmulator &panel) {
+        NexLinkStats end;
+        nexGetLinkStats(&end);
+        printf("  %-24s %6u %6u %5u %7u %7u %4u\n", name, end.tx_bytes - start.tx_bytes, end.rx_bytes - start.rx_bytes,
+               end.tx_commands - start.tx_commands, end.tx_wire_ms - start.tx_wire_ms,
+               end.rx_wire_ms - start.rx_wire_ms, panel.getStats().rejected);
+    }
+};
+
+static const uint32_t MINUTE_MS = 60'000;
+
+static void runEnhancedPanel() {
+    PanelEmulator panel;
+    addPages(panel);
+    DisplayManager disp;
+    Firmware firmware(disp);
+
+    Minute boot;
+    firmware.boot();
+    firmware.run(MINUTE_MS - Config::STARTUP_SPLASH_MS);
+    boot.report("boot, then main", panel);
+    CHECK_EQ(nexGetBaud(), Config::DISPLAY_BAUD);
+    CHECK(disp.getPanelClock() == DisplayManager::PanelClock::RUNNING);
+    CHECK_EQ(panel.getPage(), Config::DISPLAY_PAGE_MAIN);
+    CHECK(panel.getText("main.inTemp") == firmware.lastIndoorTemp());
+    CHECK(!panel.isVisible("main.indoorIndWarn"));
+    CHECK(panel.isVisible("main.energyIndWarn"));
+
+    panel.resetStats();
+    Minute main;
+    firmware.run(MINUTE_MS);
+    main.report("main, panel RTC", panel);
+    CHECK_EQ(panel.getStats().pageChanges, 0);
+
+    // Touch navigation: noticed through sendme, deferred main writes wait for main to reopen
+    panel.resetStats();
+    Minute details;
+    panel.touchPage(Config::DISPLAY_PAGE_DETAILS);
+    firmware.run(MINUTE_MS);
+    details.report("details", panel);
+    CHECK(panel.getText("details.coDetails").compare(0, 4, "CO: ") == 0);
+    CHECK(disp.getDeferredWrites() > 0);
+
+    panel.resetStats();
+    Minute heatload;
+    panel.touchPage(Config::DISPLAY_PAGE_HEATLOAD);
+    firmware.run(MINUTE_MS);
+    heatload.report("heat load", panel);
+    CHECK(panel.getText("heatload.recommendation") == "Keep the AC on");
+
+    panel.resetStats();
+    Minute trends;
+    panel.touchPage(Config::DISPLAY_PAGE_TRENDS);
+    firmware.run(MINUTE_MS);
+    trends.report("trends (2 x 240 points)", panel);
+    CHECK(panel.getStats().transparentBytes >= 2 * 240);
+    CHECK_EQ(disp.getWaveformFailures(), 0);
+
+    // Back on main, then the panel sleeps: nothing may reach it
+    panel.touchPage(Config::DISPLAY_PAGE_MAIN);
+    firmware.run(2000);
+    panel.resetStats();
+    Minute asleep;
+    panel.sleep();
+    firmware.run(MINUTE_MS);
+    asleep.report("asleep", panel);
+    CHECK_EQ(panel.getStats().commands, 0);
+
+    panel.resetStats();
+    Minute awake;
+    panel.wake();
+    firmware.run(MINUTE_MS);
+    awake.report("woken, main", panel);
+    // Of the main writes held, only the readings that changed reach the wire: temperature, current
+    // and the daily estimate. Humidity cycles back to the value on screen every 30 s; statuses,
+    // weather and indicators did not change.
+    CHECK_EQ(disp.getWakeReplayedWrites(), 3);
+    CHECK(panel.getText("main.inTemp") == firmware.lastIndoorTemp());
+    CHECK(panel.isVisible("main.energyIndWarn"));
+
+    CHECK_EQ(disp.getCommandErrors(), 0);
+}
+
+// Basic series: the clock registers are refused, so the MCU sends the time every second
+static void runBasicPanel() {
+    PanelEmulator panel(false);
+    addPages(panel);
+    DisplayManager disp;
+    Firmware firmware(disp);
+
+    firmware.boot();
+    firmware.run(MINUTE_MS - Config::STARTUP_SPLASH_MS);
+    CHECK(disp.getPanelClock() == DisplayManager::PanelClock::MISSING);
+    CHECK_EQ(panel.getStats().rejected, 6); // rtc0..rtc5
+
+    panel.resetStats();
+    Minute main;
+    firmware.run(MINUTE_MS);
+    main.report("main, MCU clock", panel);
+    CHECK_EQ(panel.getText("main.time").size(), 8);
+    CHECK_EQ(disp.getCommandErrors(), 0);
+}
+
+int main() {
+    printf("Per simulated minute at %u baud:\n", (unsigned)Config::DISPLAY_BAUD);
+    printf("  %-24s %6s %6s %5s %7s %7s %4s\n", "scenario", "tx B", "rx B", "cmds", "tx ms", "rx ms", "err");
+    runEnhancedPanel();
+    runBasicPanel();
+    return checkResult("test_display_link");
+}
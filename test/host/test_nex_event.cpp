@@ -0,0 +1,148 @@
+// nexDecodeEvent: every frame type, every error code, and frames one byte short or long
+#include "NexEvent.h"
+#include "check.h"
+
+#include <string>
+
+static bool decode(const std::string &frame, NexEvent *event) {
+    return nexDecodeEvent((const uint8_t *)frame.data(), frame.size(), event);
+}
+
+static NexEventType typeOf(const std::string &frame) {
+    NexEvent event;
+    decode(frame, &event);
+    return event.type;
+}
+
+static std::string bytes(std::initializer_list<uint8_t> list) { return std::string(list.begin(), list.end()); }
+
+static void testFrameTypes() {
+    NexEvent event;
+
+    CHECK(decode(bytes({0x00, 0x00, 0x00}), &event));
+    CHECK_EQ(event.type, NEX_EVT_STARTUP);
+
+    CHECK(decode(bytes({0x01}), &event));
+    CHECK_EQ(event.type, NEX_EVT_CMD_FINISHED);
+    CHECK_EQ(event.code, 0x01);
+
+    CHECK(decode(bytes({0x65, 0x02, 0x07, 0x01}), &event));
+    CHECK_EQ(event.type, NEX_EVT_TOUCH);
+    CHECK_EQ(event.page_id, 2);
+    CHECK_EQ(event.component_id, 7);
+    CHECK_EQ(event.touch, 1);
+
+    CHECK(decode(bytes({0x66, 0x03}), &event));
+    CHECK_EQ(event.type, NEX_EVT_PAGE);
+    CHECK_EQ(event.page_id, 3);
+
+    CHECK(decode(bytes({0x67, 0x01, 0x2C, 0x00, 0xF0, 0x00}), &event));
+    CHECK_EQ(event.type, NEX_EVT_POSITION);
+    CHECK_EQ(event.x, 300);
+    CHECK_EQ(event.y, 240);
+    CHECK_EQ(event.touch, 0);
+
+    CHECK(decode(bytes({0x68, 0x00, 0x10, 0x01, 0x00, 0x01}), &event));
+    CHECK_EQ(event.type, NEX_EVT_SLEEP_POSITION);
+    CHECK_EQ(event.x, 16);
+    CHECK_EQ(event.y, 256);
+    CHECK_EQ(event.touch, 1);
+
+    CHECK(decode("\x70" "21.5", &event));
+    CHECK_EQ(event.type, NEX_EVT_STRING);
+    CHECK(std::string((const char *)event.text, event.text_len) == "21.5");
+    CHECK(decode("\x70", &event)); // Empty string
+    CHECK_EQ(event.type, NEX_EVT_STRING);
+    CHECK_EQ(event.text_len, 0);
+
+    CHECK(decode(bytes({0x71, 0x78, 0x56, 0x34, 0x12}), &event)); // Little endian
+    CHECK_EQ(event.type, NEX_EVT_NUMBER);
+    CHECK_EQ(event.number, 0x12345678);
+    CHECK(decode(bytes({0x71, 0xFF, 0xFF, 0xFF, 0xFF}), &event));
+    CHECK_EQ(event.number, 0xFFFFFFFFu);
+
+    CHECK_EQ(typeOf(bytes({0x86})), NEX_EVT_SLEEP);
+    CHECK_EQ(typeOf(bytes({0x87})), NEX_EVT_WAKE);
+    CHECK_EQ(typeOf(bytes({0x88})), NEX_EVT_READY);
+    CHECK_EQ(typeOf(bytes({0x89})), NEX_EVT_UPGRADE);
+    CHECK_EQ(typeOf(bytes({0xFE})), NEX_EVT_TRANSPARENT_READY);
+    CHECK_EQ(typeOf(bytes({0xFD})), NEX_EVT_TRANSPARENT_DONE);
+}
+
+static void testErrorCodes() {
+    const uint8_t codes[] = {
+        NEX_RET_INVALID_CMD,         NEX_RET_INVALID_COMPONENT_ID, NEX_RET_INVALID_PAGE_ID,
+        NEX_RET_INVALID_PICTURE_ID,  NEX_RET_INVALID_FONT_ID,      NEX_RET_INVALID_FILE_OPERATION,
+        NEX_RET_INVALID_CRC,         NEX_RET_INVALID_BAUD,         NEX_RET_INVALID_WAVEFORM,
+        NEX_RET_INVALID_VARIABLE,    NEX_RET_INVALID_OPERATION,    NEX_RET_ASSIGNMENT_FAILED,
+        NEX_RET_EEPROM_FAILED,       NEX_RET_INVALID_PARAM_COUNT,  NEX_RET_IO_FAILED,
+        NEX_RET_INVALID_ESCAPE,      NEX_RET_NAME_TOO_LONG,        NEX_RET_BUFFER_OVERFLOW,
+    };
+    int errors = 0;
+    for (uint8_t code : codes) {
+        NexEvent event;
+        CHECK(nexIsErrorCode(code));
+        CHECK(decode(bytes({code}), &event));
+        CHECK_EQ(event.type, NEX_EVT_ERROR);
+        CHECK_EQ(event.code, code);
+        CHECK_EQ(typeOf(bytes({code, 0x00})), NEX_EVT_UNKNOWN); // An error is a single byte
+    }
+
+    // No other header is an error
+    for (int code = 0; code < 256; code++) {
+        if (nexIsErrorCode(code)) errors++;
+    }
+    CHECK_EQ(errors, sizeof(codes));
+    CHECK(!nexIsErrorCode(NEX_RET_CMD_FINISHED));
+    CHECK(!nexIsErrorCode(NEX_RET_TRANSPARENT_READY));
+}
+
+static void testMalformedFrames() {
+    // Each fixed-size frame one byte short and one byte long
+    const std::string valid[] = {
+        bytes({0x01}),
+        bytes({0x65, 0x02, 0x07, 0x01}),
+        bytes({0x66, 0x03}),
+        bytes({0x67, 0x01, 0x2C, 0x00, 0xF0, 0x00}),
+        bytes({0x68, 0x00, 0x10, 0x01, 0x00, 0x01}),
+        bytes({0x71, 0x78, 0x56, 0x34, 0x12}),
+        bytes({0x86}),
+        bytes({0x87}),
+        bytes({0x88}),
+        bytes({0x89}),
+        bytes({0xFE}),
+        bytes({0xFD}),
+    };
+    for (const std::string &frame : valid) {
+        NexEvent event;
+        CHECK(typeOf(frame) != NEX_EVT_UNKNOWN);
+        if (frame.size() > 1) {
+            CHECK(!decode(frame.substr(0, frame.size() - 1), &event));
+            CHECK_EQ(event.type, NEX_EVT_UNKNOWN);
+            CHECK_EQ(event.code, (uint8_t)frame[0]); // The header is kept for logging
+        }
+        CHECK(!decode(frame + '\x00', &event));
+        CHECK_EQ(event.type, NEX_EVT_UNKNOWN);
+    }
+
+    // Startup needs all three zeros; two are neither startup nor an error
+    CHECK_EQ(typeOf(bytes({0x00, 0x00})), NEX_EVT_UNKNOWN);
+    CHECK_EQ(typeOf(bytes({0x00, 0x00, 0x00, 0x00})), NEX_EVT_UNKNOWN);
+    CHECK_EQ(typeOf(bytes({0x00, 0x01, 0x00})), NEX_EVT_UNKNOWN);
+
+    // Headers Nextion never sends, and nothing at all
+    CHECK_EQ(typeOf(bytes({0x42})), NEX_EVT_UNKNOWN);
+    CHECK_EQ(typeOf(bytes({0xFF})), NEX_EVT_UNKNOWN);
+    NexEvent event;
+    CHECK(!nexDecodeEvent(nullptr, 0, &event));
+    CHECK(!nexDecodeEvent((const uint8_t *)"\x01", 0, &event));
+    CHECK_EQ(event.type, NEX_EVT_UNKNOWN);
+    CHECK(!nexDecodeEvent((const uint8_t *)"\x01", 1, nullptr));
+}
+
+int main() {
+    testFrameTypes();
+    testErrorCodes();
+    testMalformedFrames();
+    return checkResult("test_nex_event");
+}
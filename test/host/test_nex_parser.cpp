@@ -0,0 +1,159 @@
+// NexParser: frames split across feed() calls, 0xFF inside payloads, oversized frames, and a
+// full ring buffer dropping frames and resyncing
+#include "NexParser.h"
+#include "check.h"
+
+#include <string>
+
+static const std::string TERM = "\xFF\xFF\xFF";
+
+static std::string frame(const std::string &bytes) { return bytes + TERM; }
+
+static uint16_t feed(NexParser &parser, const std::string &bytes) {
+    return parser.feed((const uint8_t *)bytes.data(), bytes.size());
+}
+
+// The oldest queued frame, empty if none
+static std::string pop(NexParser &parser) {
+    uint8_t buffer[NEX_PARSER_FRAME_MAX];
+    uint16_t len = parser.read(buffer, sizeof(buffer));
+    return std::string((const char *)buffer, len);
+}
+
+static void testSplitFeeds() {
+    NexParser parser;
+    std::string page = frame(std::string("\x66\x02", 2));
+    for (char c : page.substr(0, page.size() - 1)) CHECK(!parser.feed((uint8_t)c));
+    CHECK(parser.feed((uint8_t)page.back()));
+    CHECK(pop(parser) == std::string("\x66\x02", 2));
+
+    // Split inside the payload and between the terminator bytes
+    CHECK_EQ(feed(parser, "\x70he"), 0);
+    CHECK_EQ(feed(parser, "llo\xFF"), 0);
+    CHECK_EQ(feed(parser, "\xFF"), 0);
+    CHECK_EQ(feed(parser, "\xFF\x01\xFF"), 1);
+    CHECK_EQ(parser.available(), 1);
+    CHECK_EQ(feed(parser, "\xFF\xFF"), 1);
+    CHECK(pop(parser) == "\x70hello");
+    CHECK(pop(parser) == "\x01");
+
+    // A fixed-length frame split across three calls, one of them empty
+    std::string touch = frame(std::string("\x65\x00\x03\x01", 4));
+    CHECK_EQ(feed(parser, touch.substr(0, 2)), 0);
+    CHECK_EQ(feed(parser, ""), 0);
+    CHECK_EQ(feed(parser, touch.substr(2)), 1);
+    CHECK(pop(parser) == touch.substr(0, 4));
+
+    // Several frames in one call
+    CHECK_EQ(feed(parser, frame("\x86") + frame("\x87") + frame("\x88")), 3);
+    CHECK(pop(parser) == "\x86");
+    CHECK(pop(parser) == "\x87");
+    CHECK(pop(parser) == "\x88");
+    CHECK_EQ(parser.available(), 0);
+    CHECK(pop(parser).empty());
+    CHECK_EQ(parser.getDropped(), 0);
+}
+
+static void testFFInsidePayloads() {
+    NexParser parser;
+
+    // 0x71 has a fixed length, so a number made of 0xFF bytes is not taken for the terminator
+    CHECK_EQ(feed(parser, frame("\x71\xFF\xFF\xFF\xFF")), 1);
+    CHECK(pop(parser) == "\x71\xFF\xFF\xFF\xFF");
+    CHECK_EQ(feed(parser, frame(std::string("\x71\x01\xFF\xFF\x00", 5))), 1);
+    CHECK(pop(parser) == std::string("\x71\x01\xFF\xFF\x00", 5));
+
+    // 0x66/0x67 likewise
+    CHECK_EQ(feed(parser, frame("\x66\xFF")), 1);
+    CHECK(pop(parser) == "\x66\xFF");
+    CHECK_EQ(feed(parser, frame(std::string("\x67\x01\xFF\x00\xFF\x01", 6))), 1);
+    CHECK(pop(parser) == std::string("\x67\x01\xFF\x00\xFF\x01", 6));
+
+    // 0x70 ends at the first three 0xFF in a row; one or two inside the text are kept
+    CHECK_EQ(feed(parser, frame("\x70" "a\xFF" "b\xFF\xFF" "c")), 1);
+    CHECK(pop(parser) == "\x70" "a\xFF" "b\xFF\xFF" "c");
+    CHECK_EQ(feed(parser, frame("\x70\xFF\xFF" "x")), 1);
+    CHECK(pop(parser) == "\x70\xFF\xFF" "x");
+
+    // Still in step afterwards
+    CHECK_EQ(feed(parser, frame("\x01")), 1);
+    CHECK(pop(parser) == "\x01");
+    CHECK_EQ(parser.getDropped(), 0);
+}
+
+static void testOversizedFrames() {
+    NexParser parser;
+
+    // The largest frame that fits
+    std::string largest = "\x70" + std::string(NEX_PARSER_FRAME_MAX - 1, 'x');
+    CHECK_EQ(feed(parser, frame(largest)), 1);
+    CHECK(pop(parser) == largest);
+
+    // One byte more is dropped, and the frame after it still parses
+    CHECK_EQ(feed(parser, frame(largest + "x") + frame("\x01")), 1);
+    CHECK_EQ(parser.getDropped(), 1);
+    CHECK(pop(parser) == "\x01");
+
+    // Far over: everything up to the next terminator is skipped
+    std::string huge = "\x70" + std::string(3 * NEX_PARSER_FRAME_MAX, 'y');
+    CHECK_EQ(feed(parser, frame(huge) + frame("\x66\x04")), 1);
+    CHECK_EQ(parser.getDropped(), 2);
+    CHECK(pop(parser) == "\x66\x04");
+
+    // A fixed-length frame without its terminator where expected is dropped, and the parser
+    // resyncs on the next terminator
+    CHECK_EQ(feed(parser, std::string("\x66\x01\x00\x00\x00", 5) + "junk" + TERM + frame("\x87")), 1);
+    CHECK_EQ(parser.getDropped(), 3);
+    CHECK(pop(parser) == "\x87");
+
+    // A short read truncates but still consumes the frame
+    CHECK_EQ(feed(parser, frame("\x70" "abcdef") + frame("\x01")), 2);
+    uint8_t small[3];
+    CHECK_EQ(parser.read(small, sizeof(small)), 3);
+    CHECK(std::string((const char *)small, 3) == "\x70" "ab");
+    CHECK(pop(parser) == "\x01");
+}
+
+static void testRingFull() {
+    NexParser parser;
+
+    // Each frame takes its length plus one byte in the ring
+    const size_t frameLen = 10;
+    const size_t fit = NEX_PARSER_RING_SIZE / (frameLen + 1);
+    auto numbered = [&](size_t i) { return "\x70" + std::string(frameLen - 1, (char)('a' + i % 26)); };
+
+    for (size_t i = 0; i < fit; i++) CHECK_EQ(feed(parser, frame(numbered(i))), 1);
+    CHECK_EQ(parser.available(), fit);
+    CHECK_EQ(parser.getDropped(), 0);
+
+    // No room: the frame is dropped whole, and the ones queued are untouched
+    CHECK_EQ(feed(parser, frame(numbered(fit))), 1);
+    CHECK_EQ(parser.available(), fit);
+    CHECK_EQ(parser.getDropped(), 1);
+
+    // Reading frees room; new frames wrap around the end of the ring in order
+    CHECK(pop(parser) == numbered(0));
+    CHECK(pop(parser) == numbered(1));
+    CHECK_EQ(feed(parser, frame(numbered(fit + 1)) + frame(numbered(fit + 2))), 2);
+    CHECK_EQ(parser.available(), fit);
+    for (size_t i = 2; i < fit; i++) CHECK(pop(parser) == numbered(i));
+    CHECK(pop(parser) == numbered(fit + 1));
+    CHECK(pop(parser) == numbered(fit + 2));
+    CHECK_EQ(parser.available(), 0);
+
+    // reset() forgets a partial frame and everything queued
+    CHECK_EQ(feed(parser, frame("\x01") + "\x70partial"), 1);
+    parser.reset();
+    CHECK_EQ(parser.available(), 0);
+    CHECK_EQ(feed(parser, frame("\x88")), 1);
+    CHECK(pop(parser) == "\x88");
+    CHECK_EQ(parser.getDropped(), 1);
+}
+
+int main() {
+    testSplitFeeds();
+    testFFInsidePayloads();
+    testOversizedFrames();
+    testRingFull();
+    return checkResult("test_nex_parser");
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Convert the output of the AIRIA `trace` console command into a Chrome trace_event file.
+
+Capture the console output (telnet or serial log) to a file, then:
+
+    python3 tools/trace_to_chrome.py capture.txt trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev. Anything around the
+"# trace" ... "# end" block is ignored; with several blocks the last one is used.
+
+Each record carries the span's start and length in CPU cycles and millis() when it closed.
+The 32-bit cycle counter wraps every 2^32 cycles (53 s at 80 MHz), so the records are placed
+one after the other: the millis() difference between neighbours says how many wraps fell in
+between, the cycle counts give the exact offset.
+"""
+
+import json
+import sys
+
+WRAP = 1 << 32
+
+
+def read_records(lines):
+    mhz, records, block = None, None, False
+    for line in lines:
+        line = line.strip()
+        if line.startswith("# trace"):
+            fields = dict(f.split("=", 1) for f in line.split()[2:] if "=" in f)
+            mhz = int(fields["cpu_mhz"])
+            records, block = [], True
+        elif line == "# end":
+            block = False
+        elif block and line:
+            end_ms, start_cycles, cycles, name = line.split(maxsplit=3)
+            records.append((int(end_ms), int(start_cycles), int(cycles), name))
+    if records is None:
+        sys.exit("no '# trace' block in the input")
+    return mhz, records
+
+
+def to_events(mhz, records):
+    events = []
+    prev_end_ms = prev_end = abs_end = None
+    for end_ms, start_cycles, cycles, name in records:
+        end = (start_cycles + cycles) % WRAP
+        if prev_end is None:
+            origin_us = end_ms * 1000  # First record ends at its millis(), the rest follow from it
+            abs_end = 0
+        else:
+            delta = (end - prev_end) % WRAP
+            expected = (end_ms - prev_end_ms) * 1000 * mhz
+            wraps = max(0, round((expected - delta) / WRAP))
+            abs_end += delta + wraps * WRAP
+        prev_end, prev_end_ms = end, end_ms
+
+        events.append({
+            "name": name,
+            "cat": name.split(".")[0],
+            "ph": "X",
+            "ts": origin_us + (abs_end - cycles) / mhz,
+            "dur": cycles / mhz,
+            "pid": 1,
+            "tid": 1,
+        })
+    return events
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.exit("usage: trace_to_chrome.py <capture.txt|-> [trace.json]")
+
+    source = sys.stdin if argv[1] == "-" else open(argv[1], encoding="utf-8", errors="replace")
+    with source:
+        mhz, records = read_records(source)
+
+    trace = {"traceEvents": to_events(mhz, records), "displayTimeUnit": "ms"}
+    if len(argv) == 3:
+        with open(argv[2], "w", encoding="utf-8") as out:
+            json.dump(trace, out)
+    else:
+        json.dump(trace, sys.stdout)
+    print(f"{len(records)} spans at {mhz} MHz", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main(sys.argv)